@@ -0,0 +1,300 @@
+#include "fuzz.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include "../pipeline/process.hpp"
+#include "../pipeline/output.hpp"
+
+#include "../../../global/vm/run.hpp"
+#include "../../../global/vm/loader.hpp"
+#include "../../../generator/random.hpp"
+#include "../../../generator/interpret.hpp"
+#include "../../../generator/reduce.hpp"
+
+
+namespace
+{
+	constexpr size_t min_outlier_samples = 30;
+	constexpr double outlier_mads = 6;
+	// a looping miscompile must not hang a worker; the budgets are far above what a correct program needs
+	constexpr std::chrono::seconds compile_timeout(5);
+	constexpr uint64_t steps_per_operation = 1000;
+	constexpr uint64_t min_steps = 1'000'000;
+
+	template <class T>
+	std::string join(const std::vector<T>& values)
+	{
+		std::string line;
+		for (const T& value : values)
+			line += std::format("{}{}", line.empty() ? "" : " ", value);
+		return line;
+	}
+
+	struct Verdict
+	{
+		std::optional<FuzzKind> kind;	// nothing if the program compiled and ran correctly
+		std::string message;
+		double ratio = 0;				// VM cost per interpreter operation
+	};
+
+	struct Case
+	{
+		gen::RandomCase random;
+		std::optional<gen::Execution> expected;
+		Verdict verdict;
+	};
+
+	class Fuzzer
+	{
+	public:
+
+		Fuzzer(const Config& config, const Arguments& args)
+			: m_args(args),
+			m_compiler(std::filesystem::path("." / config.compiler_exe_path).string()),
+			m_dir(config.compiled_dir / "fuzz")
+		{
+			if (!std::filesystem::exists(m_compiler))
+				throw std::runtime_error(std::format("compiler binary '{}' not found", m_compiler));
+			std::filesystem::create_directories(m_dir / "work");
+		}
+
+		~Fuzzer()
+		{
+			std::error_code error;
+			std::filesystem::remove_all(m_dir / "work", error);
+		}
+
+		// compiles the program into the worker's own files and runs it on the VM
+		Verdict evaluate(const gen::Program& program, const std::vector<uint64_t>& input, const gen::Execution& expected, const size_t worker) const
+		{
+			const std::filesystem::path source = m_dir / "work" / std::format("{}.imp", worker);
+			const CompilerOutput target(m_dir / "work" / std::format("{}.mr", worker), m_args.in_memory);
+			{
+				std::ofstream ofstr(source);
+				ofstr << gen::print(program);
+			}
+
+			try {
+				const ProcessResult process = runProcess({m_compiler, source.string(), target.path().string()}, {}, compile_timeout);
+				if (process.timed_out)
+					return Verdict { .kind = FuzzKind::CompileTimeout, .message = std::format("compiler still running after {} s", compile_timeout.count()) };
+				if (process.returncode < 0)
+					return Verdict { .kind = FuzzKind::Crash, .message = std::format("compiler killed by signal {}", -process.returncode) };
+				if (process.returncode != 0)
+					return Verdict { .kind = FuzzKind::Rejected, .message = std::format("compiler returned code {}", process.returncode) };
+			}
+			catch (const std::exception& e) {
+				return Verdict { .kind = FuzzKind::Rejected, .message = e.what() };
+			}
+
+			auto loaded = vm::loadProgram(target.path());
+			if (!loaded)
+				return Verdict { .kind = FuzzKind::InvalidProgram, .message = loaded.error().describe() };
+			vm::Program decoded = std::move(*loaded);
+
+			const std::vector<var_t> cin(input.begin(), input.end());
+			std::vector<var_t> output;
+			const uint64_t steps = std::max(expected.operations * steps_per_operation, min_steps);
+			std::optional<var_t> cost;
+			try {
+				if (m_args.fusion)
+					vm::fuse(decoded);
+				cost = vm::runLimited(decoded, cin, output, m_args.engine, steps);
+			}
+			catch (const std::exception& e) {
+				return Verdict { .kind = FuzzKind::RuntimeError, .message = e.what() };
+			}
+			if (!cost)
+				return Verdict { .kind = FuzzKind::StepLimit, .message = std::format("still running after {} instructions ({} operations expected)", steps, expected.operations) };
+			if (*cost < 0)
+				return Verdict { .kind = FuzzKind::RuntimeError, .message = "READ past the end of the input" };
+
+			if (!std::equal(output.begin(), output.end(), expected.output.begin(), expected.output.end(),
+				[](const var_t got, const uint64_t want) { return static_cast<uint64_t>(got) == want; }))
+			{
+				return Verdict { .kind = FuzzKind::WrongOutput, .message = std::format("expected [{}], got [{}]", join(expected.output), join(output)) };
+			}
+
+			return Verdict { .ratio = static_cast<double>(*cost) / std::max<uint64_t>(expected.operations, 1) };
+		}
+
+		// the reduced program, still failing the same way
+		gen::Program reduce(const Case& c, const double outlier_ratio, const size_t worker) const
+		{
+			const FuzzKind kind = *c.verdict.kind;
+			return gen::reduce(c.random.program, [&](const gen::Program& candidate) {
+				const auto expected = gen::interpret(candidate, c.random.input);
+				if (!expected)
+					return false;
+				const Verdict verdict = evaluate(candidate, c.random.input, *expected, worker);
+				if (kind == FuzzKind::CostOutlier)
+					return !verdict.kind && verdict.ratio > outlier_ratio;
+				return verdict.kind == kind;
+			});
+		}
+
+		std::filesystem::path save(const uint32_t seed, const FuzzKind kind, const std::string& message, const gen::Program& program, const std::vector<uint64_t>& input) const
+		{
+			// the same header as the benchmark programs: `? input` and `> expected output`
+			std::vector<std::string> comments = {
+				std::format("fuzz: {} (seed {}, size {})", fuzzKindName(kind), seed, m_args.fuzz_size),
+				message,
+			};
+			for (const uint64_t value : input)
+				comments.push_back(std::format("? {}", value));
+			if (const auto expected = gen::interpret(program, input))
+			{
+				for (const uint64_t value : expected->output)
+					comments.push_back(std::format("> {}", value));
+			}
+
+			const std::filesystem::path file = m_dir / std::format("{}-{}.imp", fuzzKindName(kind), seed);
+			std::ofstream ofstr(file);
+			ofstr << gen::print(program, comments);
+			return file;
+		}
+
+	private:
+
+		const Arguments& m_args;
+		const std::string m_compiler;
+		const std::filesystem::path m_dir;
+	};
+
+	// every worker writes only its own slots, like runBenchmarks()
+	template <class F>
+	void parallel(const size_t count, const unsigned jobs, F task)
+	{
+		std::atomic<size_t> next = 0;
+		std::atomic<size_t> workers_started = 0;
+		auto worker = [&]() {
+			const size_t id = workers_started++;
+			for (size_t i = next++; i < count; i = next++)
+				task(i, id);
+		};
+
+		const size_t threads = std::clamp<size_t>(jobs, 1, std::max<size_t>(count, 1));
+		std::vector<std::jthread> pool;
+		for (size_t i = 1; i < threads; i++)
+			pool.emplace_back(worker);
+		worker();
+	}
+
+	// exp(median + 6 scaled MADs) of the log cost ratios of all correct programs
+	double outlierRatio(const std::vector<Case>& cases)
+	{
+		std::vector<double> logs;
+		for (const auto& c : cases)
+		{
+			if (c.expected && !c.verdict.kind && c.verdict.ratio > 0)
+				logs.push_back(std::log(c.verdict.ratio));
+		}
+		if (logs.size() < min_outlier_samples)
+			return 0;
+
+		auto median = [](std::vector<double> values) {
+			std::sort(values.begin(), values.end());
+			const size_t n = values.size();
+			return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+		};
+		const double mid = median(logs);
+		std::vector<double> deviations;
+		for (const double x : logs)
+			deviations.push_back(std::abs(x - mid));
+		// 1.4826 scales the MAD to a standard deviation; the floor keeps identical ratios from flagging everything
+		const double mad = std::max(median(deviations) * 1.4826, 0.05);
+		return std::exp(mid + outlier_mads * mad);
+	}
+}
+
+
+std::string_view fuzzKindName(const FuzzKind kind)
+{
+	switch (kind)
+	{
+	case FuzzKind::Crash:			return "crash";
+	case FuzzKind::CompileTimeout:	return "compile-timeout";
+	case FuzzKind::Rejected:		return "rejected";
+	case FuzzKind::InvalidProgram:	return "invalid-program";
+	case FuzzKind::RuntimeError:	return "runtime-error";
+	case FuzzKind::StepLimit:		return "step-limit";
+	case FuzzKind::WrongOutput:		return "wrong-output";
+	case FuzzKind::CostOutlier:		return "cost-outlier";
+	}
+	return "";
+}
+
+FuzzReport runFuzzer(const Config& config, const Arguments& args)
+{
+	const Fuzzer fuzzer(config, args);
+
+	std::vector<Case> cases(args.fuzz_cases);
+	parallel(cases.size(), args.jobs, [&](const size_t i, const size_t worker) {
+		Case& c = cases[i];
+		c.random = gen::randomCase(args.fuzz_seed + static_cast<uint32_t>(i), args.fuzz_size);
+		c.expected = gen::interpret(c.random.program, c.random.input);
+		if (c.expected)
+			c.verdict = fuzzer.evaluate(c.random.program, c.random.input, *c.expected, worker);
+	});
+
+	FuzzReport report {
+		.cases = cases.size(),
+		.valid = static_cast<size_t>(std::count_if(cases.begin(), cases.end(), [](const Case& c) { return c.expected.has_value(); })),
+		.outlier_ratio = outlierRatio(cases),
+		.findings = {},
+	};
+
+	std::vector<size_t> failing;
+	for (size_t i = 0; i < cases.size(); i++)
+	{
+		Case& c = cases[i];
+		if (!c.expected)
+			continue;
+		if (!c.verdict.kind && report.outlier_ratio > 0 && c.verdict.ratio > report.outlier_ratio)
+		{
+			c.verdict.kind = FuzzKind::CostOutlier;
+			c.verdict.message = std::format("{:.1f} cost per operation (outliers above {:.1f})", c.verdict.ratio, report.outlier_ratio);
+		}
+		if (c.verdict.kind)
+			failing.push_back(i);
+	}
+
+	report.findings.resize(failing.size());
+	parallel(failing.size(), args.jobs, [&](const size_t k, const size_t worker) {
+		const size_t i = failing[k];
+		const Case& c = cases[i];
+		const gen::Program reduced = fuzzer.reduce(c, report.outlier_ratio, worker);
+		const uint32_t seed = args.fuzz_seed + static_cast<uint32_t>(i);
+
+		// describe the reduced program, that is the one in the file
+		std::string message = c.verdict.message;
+		if (const auto expected = gen::interpret(reduced, c.random.input))
+		{
+			const Verdict verdict = fuzzer.evaluate(reduced, c.random.input, *expected, worker);
+			if (verdict.kind)
+				message = verdict.message;
+			else if (c.verdict.kind == FuzzKind::CostOutlier)
+				message = std::format("{:.1f} cost per operation (outliers above {:.1f})", verdict.ratio, report.outlier_ratio);
+		}
+
+		report.findings[k] = FuzzFinding {
+			.seed = seed,
+			.kind = *c.verdict.kind,
+			.message = message,
+			.file = fuzzer.save(seed, *c.verdict.kind, message, reduced, c.random.input),
+			.commands = gen::commandCount(c.random.program),
+			.reduced_commands = gen::commandCount(reduced),
+		};
+	});
+
+	return report;
+}
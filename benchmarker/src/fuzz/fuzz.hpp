@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string_view>
+
+#include "../input/struct.hpp"
+#include "../input/argparser.hpp"
+
+
+std::string_view fuzzKindName(FuzzKind kind);
+
+/**
+ * @brief Compiles and runs `args.fuzz_cases` random programs on a pool of `args.jobs` workers.
+ *
+ * @details
+ * Case k uses the seed `args.fuzz_seed + k`, so every finding can be regenerated on its own.
+ * Each program is first run on the reference interpreter (gen::interpret); programs it rejects are skipped.
+ * The rest is compiled and run on the VM, and compared with the interpreter in output and cost per operation;
+ * the compiler gets 5 seconds and the VM 1000 instructions per interpreter operation before a case is a finding;
+ * a cost per operation more than 6 scaled MADs above the median (on a log scale, with at least 30 programs)
+ * is an outlier. Every finding is reduced (gen::reduce) and written to `<compiled-dir>/fuzz/<kind>-<seed>.imp`.
+ * Throws std::runtime_error if the compiler does not exist.
+ */
+FuzzReport runFuzzer(const Config& config, const Arguments& args);
@@ -0,0 +1,170 @@
+#include "history.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <nlohmann/json.hpp>
+#include <KEUL/KEUL.hpp>
+
+#include "../pipeline/timing.hpp"
+
+using json = nlohmann::json;
+
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(HistoryEntry, file, success, cached, cost, instructions, compile_us)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(HistoryRecord, timestamp, compiler, entries)
+
+
+namespace
+{
+	constexpr double significance = 0.01;
+	constexpr double min_compile_step = 1.2;
+
+	struct Sample
+	{
+		size_t run;
+		double value;
+	};
+
+	double median(std::vector<double> values)
+	{
+		return summarize(std::move(values)).median;
+	}
+
+	std::vector<double> values(const std::vector<Sample>& samples, const size_t begin, const size_t end)
+	{
+		std::vector<double> result;
+		for (size_t i = begin; i < end; i++)
+			result.push_back(samples[i].value);
+		return result;
+	}
+}
+
+
+HistoryRecord makeHistoryRecord(const std::string& compiler_hash, const std::vector<BenchmarkResult>& results)
+{
+	HistoryRecord record {
+		.timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count(),
+		.compiler = compiler_hash,
+		.entries = {},
+	};
+
+	for (const auto& result : results)
+	{
+		double compile_us = 0;
+		if (result.timing)
+			compile_us = result.timing->wall.median;
+		else if (result.compiler_usage)
+			compile_us = result.compiler_usage->wall_us;
+
+		record.entries.push_back(HistoryEntry {
+			.file = result.filename.filename().string(),
+			.success = result.compilation_success,
+			.cached = result.cached && !result.timing,
+			.cost = result.compilation_success ? result.new_cost : 0,
+			.instructions = result.instruction_count,
+			.compile_us = compile_us,
+		});
+	}
+
+	return record;
+}
+
+void appendHistory(const std::filesystem::path& path, const HistoryRecord& record)
+{
+	std::ofstream ofstr(path, std::ios::app);
+	if (!ofstr)
+	{
+		KE_LOGERROR("could not append to '{}'", path.string());
+		return;
+	}
+
+	// one write per record, so a crash can only leave a single damaged last line
+	ofstr << json(record).dump() + '\n' << std::flush;
+}
+
+std::vector<HistoryRecord> loadHistory(const std::filesystem::path& path)
+{
+	std::vector<HistoryRecord> records;
+
+	std::ifstream ifstr(path);
+	std::string line;
+	while (std::getline(ifstr, line))
+	{
+		if (line.empty())
+			continue;
+		try {
+			records.push_back(json::parse(line).get<HistoryRecord>());
+		}
+		catch (const std::exception&) {
+			continue;
+		}
+	}
+
+	return records;
+}
+
+std::vector<StepRegression> findStepRegressions(const std::vector<HistoryRecord>& records, const size_t window)
+{
+	// per benchmark, in run order
+	std::map<std::string, std::vector<Sample>> costs, compile_times;
+	for (size_t run = 0; run < records.size(); run++)
+	{
+		for (const auto& entry : records[run].entries)
+		{
+			if (!entry.success)
+				continue;
+			costs[entry.file].push_back({ run, static_cast<double>(entry.cost) });
+			if (!entry.cached && entry.compile_us > 0)
+				compile_times[entry.file].push_back({ run, entry.compile_us });
+		}
+	}
+
+	std::vector<StepRegression> steps;
+
+	for (const auto& [file, samples] : costs)
+	{
+		for (size_t i = 1; i < samples.size(); i++)
+		{
+			if (samples[i].value > samples[i - 1].value)
+				steps.push_back({ file, "cost", samples[i].run, samples[i - 1].value, samples[i].value });
+		}
+	}
+
+	for (const auto& [file, samples] : compile_times)
+	{
+		std::optional<StepRegression> candidate;
+		double candidate_ratio = 0;
+
+		for (size_t i = window; i + window <= samples.size(); i++)
+		{
+			const auto before = values(samples, i - window, i);
+			const auto after = values(samples, i, i + window);
+			const double before_median = median(before);
+			const double after_median = median(after);
+			const double ratio = before_median > 0 ? after_median / before_median : 0;
+
+			const bool step = ratio > min_compile_step && mannWhitneyGreater(before, after) < significance;
+			if (step && ratio > candidate_ratio)
+			{
+				candidate = StepRegression { file, "compile time", samples[i].run, before_median, after_median };
+				candidate_ratio = ratio;
+			}
+			else if (!step && candidate)
+			{
+				// end of a group of neighbouring candidates
+				steps.push_back(*candidate);
+				candidate.reset();
+				candidate_ratio = 0;
+			}
+		}
+		if (candidate)
+			steps.push_back(*candidate);
+	}
+
+	std::stable_sort(steps.begin(), steps.end(), [](const StepRegression& a, const StepRegression& b) {
+		return a.file != b.file ? a.file < b.file : a.run < b.run;
+	});
+	return steps;
+}
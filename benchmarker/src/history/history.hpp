@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../input/struct.hpp"
+
+
+struct HistoryEntry
+{
+	std::string file;
+	bool success;
+	bool cached;			// compile_us is a copy from an earlier run
+	uint64_t cost;
+	uint64_t instructions;
+	double compile_us;		// median of the timed runs, or the single compilation
+};
+
+// one line of the history file: all benchmarks of one benchmarker run
+struct HistoryRecord
+{
+	int64_t timestamp;		// seconds since the epoch
+	std::string compiler;	// content hash of the compiler executable
+	std::vector<HistoryEntry> entries;
+};
+
+struct StepRegression
+{
+	std::string file;
+	std::string metric;		// "cost" or "compile time"
+	size_t run;				// index of the first record after the step
+	double before;
+	double after;
+};
+
+HistoryRecord makeHistoryRecord(const std::string& compiler_hash, const std::vector<BenchmarkResult>& results);
+
+/**
+ * @brief Appends one record as a single JSON line; existing lines are never rewritten.
+ */
+void appendHistory(const std::filesystem::path& path, const HistoryRecord& record);
+
+// all readable records in file order; damaged lines (e.g. from an interrupted write) are skipped
+std::vector<HistoryRecord> loadHistory(const std::filesystem::path& path);
+
+/**
+ * @brief Finds the runs after which a benchmark got slower.
+ *
+ * @details
+ * Cost is deterministic, so every increase over the previous successful run is a step.
+ * Compile time is noisy: a step is reported where the `window` runs after a point are significantly
+ * slower than the `window` runs before it (one-sided Mann-Whitney U, p < 0.01) and their median
+ * grew by more than 20%; of several neighbouring candidates the largest step is kept.
+ * Cached entries are ignored for compile time.
+ */
+std::vector<StepRegression> findStepRegressions(const std::vector<HistoryRecord>& records, size_t window = 5);
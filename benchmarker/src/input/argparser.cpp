@@ -1,12 +1,85 @@
 #include "argparser.hpp"
 
+#include <algorithm>
+#include <thread>
 
-std::string parse_args(const int argc, char const* argv[])
+
+Arguments parse_args(const int argc, char const* argv[])
 {
 	argparse::ArgumentParser parser;
 	parser.add_argument<std::string>("--config-file", "-cf")
 		.help("config file")
 		.default_value("benchmarker/config.json");
+	parser.add_argument<std::string>("--engine")
+		.help("execution engine: switch, threaded or jit")
+		.default_value("threaded")
+		.choices("switch", "threaded", "jit");
+	parser.add_argument("--no-fusion")
+		.help("do not fuse common instruction sequences into superinstructions")
+		.flag();
+	parser.add_argument("--fast-forward")
+		.help("run counted loops in closed form where it is provably exact")
+		.flag();
+	parser.add_argument("--validate")
+		.help("also run every program on the reference interpreter and report any difference in cost or output")
+		.flag();
+	parser.add_argument("--jobs", "-j")
+		.help("number of benchmarks compiled and run in parallel (0: one per hardware thread); compile times and resource usage are only comparable with 1")
+		.default_value(1)
+		.scan<'i', int>();
+	parser.add_argument("--no-cache")
+		.help("always compile and run, ignoring results cached for an unchanged compiler, source and input")
+		.flag();
+	parser.add_argument("--in-memory")
+		.help("let the compiler write into an in-memory file (passed as /proc/<pid>/fd/<n>) instead of the compiled directory")
+		.flag();
+	parser.add_argument("--time-compiler")
+		.help("also time K compilations of every benchmark and compare them with the reference times (0: off)")
+		.default_value(0)
+		.scan<'i', int>();
+	parser.add_argument("--warmup")
+		.help("untimed compilations before the timed ones")
+		.default_value(2)
+		.scan<'i', int>();
+	parser.add_argument("--export")
+		.help("also write all results, including compiler timing and resource usage, to a file ('-': stdout)")
+		.default_value("");
+	parser.add_argument("--export-format")
+		.help("format of --export: json or csv")
+		.default_value("json")
+		.choices("json", "csv");
+	parser.add_argument("--ci")
+		.help("non-interactive: export the results (to stdout unless --export is given) and exit with a status describing them")
+		.flag();
+	parser.add_argument("--tolerance")
+		.help("allowed cost increase over the reference in percent, unless a benchmark sets its own 'tolerance'")
+		.default_value(0.0)
+		.scan<'g', double>();
+	parser.add_argument("--history")
+		.help("show per-benchmark trends and step regressions from the history file instead of running")
+		.flag();
+	parser.add_argument("--no-history")
+		.help("do not append this run to the history file")
+		.flag();
+	parser.add_argument("--scaling")
+		.help("compile generated programs of growing size instead of the benchmarks and fit compile time and instruction count against size")
+		.flag();
+	parser.add_argument("--scaling-max")
+		.help("largest generated size of --scaling (sizes are powers of two, at least 4 for a fit)")
+		.default_value(128)
+		.scan<'i', int>();
+	parser.add_argument("--fuzz")
+		.help("compile and run N random programs instead of the benchmarks and report crashes, runtime errors, wrong outputs and cost outliers (0: off)")
+		.default_value(0)
+		.scan<'i', int>();
+	parser.add_argument("--fuzz-seed")
+		.help("seed of the first random program; program k uses seed + k")
+		.default_value(1)
+		.scan<'i', int>();
+	parser.add_argument("--fuzz-size")
+		.help("approximate number of commands of a random program")
+		.default_value(40)
+		.scan<'i', int>();
 	try
 	{
 		parser.parse_args(argc, argv);
@@ -16,8 +89,34 @@ std::string parse_args(const int argc, char const* argv[])
 		std::println(std::cerr, "{}", e.what());
 		std::exit(1);
 	}
+	// fitExponent() needs the sizes 1, 2 and 4: one for the constant part and two for the slope
+	if (parser.get<bool>("--scaling") && parser.get<int>("--scaling-max") < 4)
+	{
+		std::println(std::cerr, "--scaling-max must be at least 4");
+		std::exit(1);
+	}
 
 	return {
-		parser.get<std::string>("--config-file"),
+		.config_file = parser.get<std::string>("--config-file"),
+		.engine = vm::engineFromString(parser.get<std::string>("--engine")).value_or(vm::Engine::Switch),
+		.fusion = !parser.get<bool>("--no-fusion"),
+		.fast_forward = parser.get<bool>("--fast-forward"),
+		.validate = parser.get<bool>("--validate"),
+		.jobs = parser.get<int>("--jobs") > 0 ? static_cast<unsigned>(parser.get<int>("--jobs")) : std::max(1u, std::thread::hardware_concurrency()),
+		.cache = !parser.get<bool>("--no-cache"),
+		.in_memory = parser.get<bool>("--in-memory"),
+		.timing_runs = static_cast<unsigned>(std::max(0, parser.get<int>("--time-compiler"))),
+		.warmup_runs = static_cast<unsigned>(std::max(0, parser.get<int>("--warmup"))),
+		.export_file = parser.get<std::string>("--export"),
+		.export_format = exportFormatFromString(parser.get<std::string>("--export-format")).value_or(ExportFormat::Json),
+		.ci = parser.get<bool>("--ci"),
+		.tolerance = parser.get<double>("--tolerance"),
+		.show_history = parser.get<bool>("--history"),
+		.record_history = !parser.get<bool>("--no-history"),
+		.scaling = parser.get<bool>("--scaling"),
+		.scaling_max = static_cast<unsigned>(std::max(1, parser.get<int>("--scaling-max"))),
+		.fuzz_cases = static_cast<unsigned>(std::max(0, parser.get<int>("--fuzz"))),
+		.fuzz_seed = static_cast<uint32_t>(parser.get<int>("--fuzz-seed")),
+		.fuzz_size = static_cast<unsigned>(std::max(1, parser.get<int>("--fuzz-size"))),
 	};
-}
\ No newline at end of file
+}
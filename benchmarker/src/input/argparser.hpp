@@ -2,5 +2,33 @@
 
 #include <argparse/argparse.hpp>
 
+#include "../../../global/vm/engine.hpp"
+#include "../report/report.hpp"
 
-std::string parse_args(const int argc, char const* argv[]);
\ No newline at end of file
+
+struct Arguments
+{
+	std::string config_file;
+	vm::Engine engine;
+	bool fusion;
+	bool fast_forward;
+	bool validate;
+	unsigned jobs;
+	bool cache;
+	bool in_memory;
+	unsigned timing_runs;
+	unsigned warmup_runs;
+	std::string export_file;
+	ExportFormat export_format;
+	bool ci;
+	double tolerance;
+	bool show_history;
+	bool record_history;
+	bool scaling;
+	unsigned scaling_max;
+	unsigned fuzz_cases;
+	uint32_t fuzz_seed;
+	unsigned fuzz_size;
+};
+
+Arguments parse_args(const int argc, char const* argv[]);
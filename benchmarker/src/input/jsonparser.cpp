@@ -22,12 +22,17 @@ Config parse_config(const std::string_view config_path)
 	std::filesystem::path benchmark_table;
 	std::filesystem::path compiler_exe_path;
 	std::filesystem::path compiled_path;
+	std::filesystem::path history_file;
 
 	try {
 		benchmarks_path = data["benchmarks-dir"].get<std::string>();
 		benchmark_table = data["benchmark-table"].get<std::string>();
 		compiler_exe_path = data["compiler-exe"].get<std::string>();
 		compiled_path = data["compiled-dir"].get<std::string>();
+		// optional, next to the benchmark table by default
+		history_file = data.contains("history-file")
+			? std::filesystem::path(data["history-file"].get<std::string>())
+			: benchmark_table.parent_path() / "history.jsonl";
 	} catch (std::exception& e) {
 		std::println(std::cerr, "{}", e.what());
 		std::exit(1);
@@ -38,6 +43,7 @@ Config parse_config(const std::string_view config_path)
 		.benchmark_table = benchmark_table,
 		.compiler_exe_path = compiler_exe_path,
 		.compiled_dir = compiled_path,
+		.history_file = history_file,
 	};
 }
 
@@ -67,12 +73,22 @@ std::vector<BenchmarkUnit> getBenchmarks(const Config& config)
 		uint64_t cost = std::numeric_limits<uint64_t>::max();
 		if (entry.contains("cost"))
 			cost = entry["cost"].get<uint64_t>();
+
+		std::optional<double> tolerance;
+		if (entry.contains("tolerance"))
+			tolerance = entry["tolerance"].get<double>();
+
+		std::vector<double> compile_wall;
+		if (entry.contains("compile-wall") && entry["compile-wall"].is_array())
+			compile_wall = entry["compile-wall"].get<std::vector<double>>();
 		
 		result.emplace_back(BenchmarkUnit {
 			.lang_filename = dir_prefix / file,
 			.asm_filename = std::filesystem::path(compiled_prefix / file).replace_extension("mr"),
 			.input = inputs,
-			.reference_cost = cost
+			.reference_cost = cost,
+			.reference_compile_wall = compile_wall,
+			.tolerance = tolerance,
 		});
 
 		const auto& last = result.back();
@@ -96,11 +112,14 @@ void overrideCosts(const Config& config, const std::vector<BenchmarkResult>& res
 
 	// Create a map of filenames to new costs for quick lookup
 	std::map<std::string, uint64_t> new_costs;
+	std::map<std::string, std::vector<double>> new_compile_walls;
 	for (const auto& result : results)
 	{
 		if (result.compilation_success)
 		{
 			new_costs[result.filename.filename().string()] = result.new_cost;
+			if (result.timing)
+				new_compile_walls[result.filename.filename().string()] = result.timing->wall_samples;
 		}
 	}
 
@@ -114,6 +133,10 @@ void overrideCosts(const Config& config, const std::vector<BenchmarkResult>& res
 			{
 				entry["cost"] = new_costs[filename];
 			}
+			if (new_compile_walls.find(filename) != new_compile_walls.end())
+			{
+				entry["compile-wall"] = new_compile_walls[filename];
+			}
 		}
 	}
 
@@ -126,4 +149,4 @@ void overrideCosts(const Config& config, const std::vector<BenchmarkResult>& res
 	}
 
 	std::println(ofstr, "{}", data.dump(4));
-}
\ No newline at end of file
+}
@@ -4,8 +4,12 @@
 
 #include "struct.hpp"
 
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ProcessUsage, wall_us, user_us, sys_us, max_rss_kb, minor_faults, major_faults, voluntary_switches, involuntary_switches, output_bytes)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TimeStats, min, median, p90, mad)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(CompileTiming, wall_samples, wall, user, sys, p_value, regression)
+
 Config parse_config(const std::string_view config_path);
 
 std::vector<BenchmarkUnit> getBenchmarks(const Config& config);
 
-void overrideCosts(const Config& config, const std::vector<BenchmarkResult>& results);
\ No newline at end of file
+void overrideCosts(const Config& config, const std::vector<BenchmarkResult>& results);
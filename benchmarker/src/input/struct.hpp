@@ -4,6 +4,7 @@
 #include <vector>
 #include <cstdint>
 #include <string>
+#include <optional>
 
 #include "../../../global/instructions.hpp"
 
@@ -13,6 +14,7 @@ struct Config
 	std::filesystem::path benchmark_table;
 	std::filesystem::path compiler_exe_path;
 	std::filesystem::path compiled_dir;
+	std::filesystem::path history_file;
 };
 
 struct BenchmarkUnit
@@ -21,6 +23,41 @@ struct BenchmarkUnit
 	const std::filesystem::path asm_filename;
 	const std::vector<var_t> input;
 	const uint64_t reference_cost;
+	const std::vector<double> reference_compile_wall = {};	// wall-time samples [µs] accepted with the reference cost
+	const std::optional<double> tolerance = {};				// allowed cost increase [%], overrides --tolerance
+};
+
+// summary of repeated measurements, all in microseconds
+struct TimeStats
+{
+	double min;
+	double median;
+	double p90;
+	double mad;		// median absolute deviation
+};
+
+struct CompileTiming
+{
+	std::vector<double> wall_samples;
+	TimeStats wall;
+	TimeStats user;
+	TimeStats sys;
+	double p_value;		// one-sided Mann-Whitney U test against the reference samples, 1 without them
+	bool regression;	// significantly slower than the reference
+};
+
+// resources used by one compiler process, from wait4(), and the size of what it emitted
+struct ProcessUsage
+{
+	double wall_us;
+	double user_us;
+	double sys_us;
+	uint64_t max_rss_kb;
+	uint64_t minor_faults;
+	uint64_t major_faults;
+	uint64_t voluntary_switches;
+	uint64_t involuntary_switches;
+	uint64_t output_bytes;		// size of the emitted program, not everything the process wrote
 };
 
 struct BenchmarkResult
@@ -28,6 +65,63 @@ struct BenchmarkResult
 	std::filesystem::path filename;
 	uint64_t reference_cost;
 	uint64_t new_cost;
-	bool compilation_success;
+	std::vector<var_t> output;
+	uint64_t instruction_count = 0;		// of the emitted .mr
+	bool compilation_success;		// false for compile and runtime errors alike
+	bool runtime_error = false;		// the compiler succeeded, but the program failed on the VM
+	std::string error_message;
+	double tolerance = 0;			// allowed cost increase over reference_cost [%]
+	bool cached = false;	// taken from the result cache, neither compiled nor run
+	std::optional<CompileTiming> timing;	// only with --time-compiler
+	std::optional<ProcessUsage> compiler_usage;	// of the compilation that produced the .mr
+};
+
+// one generated program, compiled repeatedly
+struct ScalingPoint
+{
+	size_t size;
+	bool success;
 	std::string error_message;
-};
\ No newline at end of file
+	double compile_us;			// median wall time
+	uint64_t max_rss_kb;		// largest peak RSS of all compilations
+	uint64_t instructions;		// of the emitted .mr
+};
+
+struct ScalingSeries
+{
+	std::string family;
+	std::vector<ScalingPoint> points;
+	std::optional<double> time_exponent;			// fitted k of compile time ~ size^k
+	std::optional<double> instruction_exponent;		// fitted k of instructions ~ size^k
+	bool super_linear;
+};
+
+enum class FuzzKind
+{
+	Crash,				// the compiler was killed by a signal
+	CompileTimeout,		// the compiler ran past its time limit
+	Rejected,			// the compiler failed on a valid program
+	InvalidProgram,		// the VM cannot load the emitted .mr
+	RuntimeError,		// the program failed on the VM
+	StepLimit,			// the program ran past its instruction budget on the VM
+	WrongOutput,		// the output differs from the reference interpreter
+	CostOutlier,		// far more expensive per executed operation than the other programs
+};
+
+struct FuzzFinding
+{
+	uint32_t seed;
+	FuzzKind kind;
+	std::string message;
+	std::filesystem::path file;		// reduced program, with its input and expected output as comments
+	size_t commands;				// before reduction
+	size_t reduced_commands;
+};
+
+struct FuzzReport
+{
+	size_t cases;
+	size_t valid;				// accepted by the reference interpreter
+	double outlier_ratio;		// cost per operation above which a program is an outlier, 0 with too few samples
+	std::vector<FuzzFinding> findings;
+};
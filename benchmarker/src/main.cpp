@@ -14,12 +14,9 @@
 #include <map>
 #include <filesystem>
 #include <print>
-#include <fstream>
-#include <algorithm>
-#include <stdexcept>
+#include <iostream>
 #include <argparse/argparse.hpp>
 #include <nlohmann/json.hpp>
-#include <subprocess.hpp>
 #include <KEUL/KEUL.hpp>
 
 #include "../global/colors.hpp"
@@ -27,78 +24,99 @@
 
 #include "input/argparser.hpp"
 #include "input/jsonparser.hpp"
+#include "pipeline/pipeline.hpp"
+#include "pipeline/timing.hpp"
+#include "pipeline/hash.hpp"
+#include "history/history.hpp"
+#include "scaling/scaling.hpp"
+#include "fuzz/fuzz.hpp"
 #include "tui/benchmark_ui.hpp"
+#include "tui/history_ui.hpp"
+#include "tui/scaling_ui.hpp"
+#include "tui/fuzz_ui.hpp"
+#include "report/report.hpp"
 
 
-extern void run_parser(std::vector<std::pair<int, var_t>>& program, FILE* data);
-extern var_t run_machine(std::vector<std::pair<int, var_t>>& program, const std::vector<var_t>& cin);
+int main(const int argc, char const * argv[]) {
+	
+	Arguments args = parse_args(argc, argv);
+	Config config = parse_config(args.config_file);
 
-void parse(std::vector<std::pair<int, var_t>>& program, const std::string_view filename)
-{
-	FILE* data = fopen(filename.data(), "r");
-	if( !data ) {
-		std::println(std::cerr, "{}Error: could not open '{}'{}", cRed, filename, cReset);
-		std::exit(-1);
+	if (args.show_history)
+	{
+		tui::showHistory(loadHistory(config.history_file));
+		return 0;
 	}
 
-	run_parser(program, data);
-
-	fclose(data);
-}
-
+	if (!std::filesystem::exists(config.compiler_exe_path))
+	{
+		std::println(std::cerr, "compiler binary '{}' not found", config.compiler_exe_path.string());
+	}
 
+	if (args.scaling)
+	{
+		// generated programs are neither benchmarks nor history
+		std::vector<ScalingSeries> series = runScaling(config, args);
+		if (args.ci)
+		{
+			if (!exportScaling(args.export_file.empty() ? "-" : args.export_file, args.export_format, series))
+				return 1;
+			return ciExitCode(series);
+		}
 
-int main(const int argc, char const * argv[]) {
+		if (!args.export_file.empty())
+			exportScaling(args.export_file, args.export_format, series);
+		tui::showScaling(series);
+		return 0;
+	}
 	
-	std::string filename = parse_args(argc, argv);
-	Config config = parse_config(filename);
-
-	if (!std::filesystem::exists(config.compiler_exe_path))
+	if (args.fuzz_cases > 0)
 	{
-		std::println("compiler binary '{}' not found", config.compiler_exe_path.string());
+		FuzzReport report;
+		try {
+			report = runFuzzer(config, args);
+		}
+		catch (const std::exception& e) {
+			KE_LOGERROR("{}", e.what());
+			return 1;
+		}
+
+		if (args.ci)
+		{
+			if (!exportFuzz(args.export_file.empty() ? "-" : args.export_file, args.export_format, report))
+				return 1;
+			return ciExitCode(report);
+		}
+
+		if (!args.export_file.empty())
+			exportFuzz(args.export_file, args.export_format, report);
+		tui::showFuzzReport(report);
+		return 0;
 	}
 	
 	auto programs = getBenchmarks(config);
 
-	std::vector<BenchmarkResult> results;
-	
-	for (const auto& benchmark_unit : programs)
+	std::vector<BenchmarkResult> results = runBenchmarks(config, args, programs);
+
+	if (args.timing_runs > 0)
+		timeCompilations(config, args, programs, results);
+
+	if (args.record_history)
 	{
-		BenchmarkResult result;
-		result.filename = benchmark_unit.lang_filename;
-		result.reference_cost = benchmark_unit.reference_cost;
-		result.compilation_success = true;
-		result.error_message = "";
-		
-		// launch compilation process
-		subprocess::CompletedProcess process = subprocess::run(
-			{std::filesystem::path("." / config.compiler_exe_path).string(), benchmark_unit.lang_filename.string(), benchmark_unit.asm_filename.string()},
-			subprocess::RunBuilder().cout(subprocess::PipeOption::pipe).cerr(subprocess::PipeOption::pipe)
-		);
+		const std::string compiler_hash = hashFile("." / config.compiler_exe_path).value_or("");
+		appendHistory(config.history_file, makeHistoryRecord(compiler_hash, results));
+	}
 
-		if (process.returncode != 0)
-		{
-			// compilation error
-			result.compilation_success = false;
-			result.error_message = "Compiler returned code: " + std::to_string(process.returncode);
-			result.new_cost = -1;
-		}
-		else
-		{
-			try {
-				std::vector<std::pair<int, var_t>> program;
-				parse(program, benchmark_unit.asm_filename.string());
-				result.new_cost = static_cast<uint64_t>(run_machine(program, benchmark_unit.input));
-			}
-			catch (const std::exception& e) {
-				result.compilation_success = false;
-				result.error_message = "Runtime error: " + std::string(e.what());
-				result.new_cost = -1;
-			}
-		}
-		
-		results.push_back(result);
+	if (args.ci)
+	{
+		// no TUI and no prompt: the results go to stdout unless --export names a file
+		if (!exportResults(args.export_file.empty() ? "-" : args.export_file, args.export_format, results))
+			return 1;
+		return ciExitCode(results);
 	}
+
+	if (!args.export_file.empty())
+		exportResults(args.export_file, args.export_format, results);
 	
 	// Show the FTXUI interface
 	bool should_override = tui::showBenchmarkResults(results);
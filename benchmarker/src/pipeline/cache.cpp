@@ -0,0 +1,128 @@
+#include "cache.hpp"
+
+#include <format>
+#include <fstream>
+#include <system_error>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+#include "hash.hpp"
+#include "../input/jsonparser.hpp"
+
+using json = nlohmann::json;
+
+
+namespace
+{
+	// bump whenever the entry format or the meaning of a cached result changes
+	constexpr std::string_view cache_version = "4";
+}
+
+
+ResultCache::ResultCache(std::filesystem::path dir, std::string compiler_hash)
+	: m_dir(std::move(dir)), m_compiler_hash(std::move(compiler_hash))
+{
+}
+
+std::optional<ResultCache> ResultCache::open(const std::filesystem::path& dir, const std::filesystem::path& compiler)
+{
+	const auto compiler_hash = hashFile(compiler);
+	if (!compiler_hash)
+		return std::nullopt;
+
+	std::error_code error;
+	std::filesystem::create_directories(dir, error);
+	if (error)
+		return std::nullopt;
+
+	return ResultCache(dir, *compiler_hash);
+}
+
+std::optional<std::string> ResultCache::key(const BenchmarkUnit& unit) const
+{
+	const auto source = readFile(unit.lang_filename);
+	if (!source)
+		return std::nullopt;
+
+	Fnv128 hash;
+	hash.update(cache_version).update(m_compiler_hash).update(*source);
+	// length-prefixed, so the source and the input cannot shift into each other
+	hash.update(std::format("|{}|{}:", source->size(), unit.input.size()));
+	for (const var_t value : unit.input)
+		hash.update(std::format("{},", value));
+	return hash.hex();
+}
+
+std::filesystem::path ResultCache::entryPath(const std::string& key) const
+{
+	return m_dir / (key + ".json");
+}
+
+bool ResultCache::load(const std::string& key, const BenchmarkUnit& unit, BenchmarkResult& result, const bool restore_program) const
+{
+	std::ifstream ifstr(entryPath(key));
+	if (!ifstr)
+		return false;
+
+	try {
+		const json entry = json::parse(ifstr);
+		const std::string program = entry["mr"].get<std::string>();
+		const uint64_t cost = entry["cost"].get<uint64_t>();
+		const uint64_t instructions = entry["instructions"].get<uint64_t>();
+		std::vector<var_t> output = entry["output"].get<std::vector<var_t>>();
+		std::optional<ProcessUsage> usage;
+		if (entry.contains("compiler-usage"))
+			usage = entry["compiler-usage"].get<ProcessUsage>();
+
+		if (restore_program)
+		{
+			std::ofstream ofstr(unit.asm_filename, std::ios::binary);
+			if (!(ofstr << program))
+				return false;
+		}
+
+		result.new_cost = cost;
+		result.instruction_count = instructions;
+		result.output = std::move(output);
+		result.compiler_usage = usage;
+		result.cached = true;
+		return true;
+	}
+	catch (const std::exception&) {
+		// a damaged entry is a miss; it is overwritten by the fresh result
+		return false;
+	}
+}
+
+void ResultCache::store(const std::string& key, const BenchmarkUnit& unit, const BenchmarkResult& result, const std::filesystem::path& program) const
+{
+	const auto text = readFile(program);
+	if (!text)
+		return;
+
+	json entry = {
+		{"source", unit.lang_filename.string()},
+		{"mr", *text},
+		{"cost", result.new_cost},
+		{"instructions", result.instruction_count},
+		{"output", result.output},
+	};
+	// the usage of the compilation that produced the .mr, shown again on a hit
+	if (result.compiler_usage)
+		entry["compiler-usage"] = *result.compiler_usage;
+
+	// write-then-rename, so a concurrent or interrupted run never sees half an entry
+	const auto path = entryPath(key);
+	auto temporary = path;
+	temporary += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+	{
+		std::ofstream ofstr(temporary);
+		if (!(ofstr << entry.dump()))
+			return;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary, path, error);
+	if (error)
+		std::filesystem::remove(temporary, error);
+}
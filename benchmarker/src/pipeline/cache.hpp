@@ -0,0 +1,45 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "../input/struct.hpp"
+
+
+/**
+ * @brief Content-addressed store of compiled programs and their VM results.
+ *
+ * @details
+ * An entry is keyed by a hash of the compiler executable, the source file and the input vector,
+ * and holds the emitted .mr together with the cost, the outputs and the compiler's resource usage, so an unchanged benchmark
+ * needs neither the compiler nor the VM. Entries are separate files written atomically,
+ * so workers can share one cache.
+ */
+class ResultCache
+{
+private:
+
+	std::filesystem::path m_dir;
+	std::string m_compiler_hash;
+
+public:
+
+	// returns nullopt if the compiler executable cannot be read
+	static std::optional<ResultCache> open(const std::filesystem::path& dir, const std::filesystem::path& compiler);
+
+	// nullopt if the source file cannot be read
+	std::optional<std::string> key(const BenchmarkUnit& unit) const;
+
+	// on a hit, fills cost, output and compiler usage, and restores the .mr at unit.asm_filename if `restore_program` is set
+	bool load(const std::string& key, const BenchmarkUnit& unit, BenchmarkResult& result, bool restore_program) const;
+
+	// stores a successful result together with the compiled program, read from `program` (unit.asm_filename or an in-memory output)
+	void store(const std::string& key, const BenchmarkUnit& unit, const BenchmarkResult& result, const std::filesystem::path& program) const;
+
+private:
+
+	ResultCache(std::filesystem::path dir, std::string compiler_hash);
+
+	std::filesystem::path entryPath(const std::string& key) const;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+
+// 128-bit FNV-1a; not cryptographic, only has to tell versions of the same files apart
+class Fnv128
+{
+private:
+
+	using u128 = unsigned __int128;
+
+	static constexpr u128 prime = (u128(1) << 88) | 0x13b;
+	u128 m_state = (u128(0x6c62272e07bb0142ull) << 64) | 0x62b821756295c58dull;
+
+public:
+
+	Fnv128& update(const std::string_view bytes)
+	{
+		for (const char c : bytes)
+		{
+			m_state ^= static_cast<unsigned char>(c);
+			m_state *= prime;
+		}
+		return *this;
+	}
+
+	std::string hex() const
+	{
+		return std::format("{:016x}{:016x}", static_cast<uint64_t>(m_state >> 64), static_cast<uint64_t>(m_state));
+	}
+};
+
+inline std::optional<std::string> readFile(const std::filesystem::path& path)
+{
+	std::ifstream ifstr(path, std::ios::binary);
+	if (!ifstr)
+		return std::nullopt;
+	std::ostringstream content;
+	content << ifstr.rdbuf();
+	return std::move(content).str();
+}
+
+// hex digest of the file's content, nullopt if it cannot be read
+inline std::optional<std::string> hashFile(const std::filesystem::path& path)
+{
+	const auto content = readFile(path);
+	if (!content)
+		return std::nullopt;
+	return Fnv128().update(*content).hex();
+}
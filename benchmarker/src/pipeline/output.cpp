@@ -0,0 +1,25 @@
+#include "output.hpp"
+
+#include <format>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+CompilerOutput::CompilerOutput(const std::filesystem::path& file, const bool in_memory)
+	: m_path(file)
+{
+	if (!in_memory)
+		return;
+
+	// close-on-exec: the compiler opens the memfd by the pid of this process, so it must not inherit
+	// the descriptor, and neither must the compilers other workers start at the same time
+	m_fd = ::memfd_create(file.filename().c_str(), MFD_CLOEXEC);
+	if (m_fd >= 0)
+		m_path = std::format("/proc/{}/fd/{}", ::getpid(), m_fd);
+}
+
+CompilerOutput::~CompilerOutput()
+{
+	if (m_fd >= 0)
+		::close(m_fd);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <filesystem>
+
+
+/**
+ * @brief The file the compiler writes its .mr to.
+ *
+ * @details
+ * Normally that is the given file in the compiled directory. In memory, it is an anonymous memfd that
+ * the compiler opens as `/proc/<pid>/fd/<n>`, so a compilation never touches the disk; the VM loader and
+ * the result cache read it back through the same path. The memfd is closed with the object.
+ * Falls back to the file if memfd_create() is not available.
+ */
+class CompilerOutput
+{
+private:
+
+	std::filesystem::path m_path;
+	int m_fd = -1;
+
+public:
+
+	CompilerOutput(const std::filesystem::path& file, bool in_memory);
+	~CompilerOutput();
+
+	CompilerOutput(const CompilerOutput&) = delete;
+	CompilerOutput& operator=(const CompilerOutput&) = delete;
+
+	// the output argument of the compiler, and the .mr to load afterwards
+	const std::filesystem::path& path() const { return m_path; }
+
+	bool inMemory() const { return m_fd >= 0; }
+};
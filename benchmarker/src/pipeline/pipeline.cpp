@@ -0,0 +1,149 @@
+#include "pipeline.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <format>
+#include <stdexcept>
+#include <KEUL/KEUL.hpp>
+
+#include "process.hpp"
+#include "output.hpp"
+
+#include "../../../global/vm/program.hpp"
+#include "../../../global/vm/engine.hpp"
+#include "../../../global/vm/run.hpp"
+#include "../../../global/vm/loader.hpp"
+
+
+BenchmarkResult runBenchmark(const Config& config, const Arguments& args, const BenchmarkUnit& unit, const ResultCache* cache)
+{
+	BenchmarkResult result;
+	result.filename = unit.lang_filename;
+	result.reference_cost = unit.reference_cost;
+	result.compilation_success = true;
+	result.error_message = "";
+	result.tolerance = unit.tolerance.value_or(args.tolerance);
+
+	const std::optional<std::string> key = cache ? cache->key(unit) : std::nullopt;
+	if (key && !args.validate && cache->load(*key, unit, result, !args.in_memory))
+		return result;
+
+	const CompilerOutput output(unit.asm_filename, args.in_memory);
+
+	// launch compilation process
+	try {
+		const ProcessResult process = runProcess(
+			{std::filesystem::path("." / config.compiler_exe_path).string(), unit.lang_filename.string(), output.path().string()},
+			output.path()
+		);
+		result.compiler_usage = process.usage;
+
+		if (process.returncode != 0)
+		{
+			// compilation error
+			result.compilation_success = false;
+			result.error_message = "Compiler returned code: " + std::to_string(process.returncode);
+			result.new_cost = -1;
+			return result;
+		}
+	}
+	catch (const std::exception& e) {
+		result.compilation_success = false;
+		result.error_message = e.what();
+		result.new_cost = -1;
+		return result;
+	}
+
+	// a .mr the VM cannot load is the compiler's fault
+	auto loaded = vm::loadProgram(output.path());
+	if (!loaded)
+	{
+		result.compilation_success = false;
+		result.error_message = "Invalid program: " + loaded.error().describe();
+		result.new_cost = -1;
+		return result;
+	}
+	vm::Program decoded = std::move(*loaded);
+	result.instruction_count = decoded.code.size();
+
+	try {
+		var_t cost;
+		if (args.validate)
+		{
+			// reference run: plain switch interpreter on the unfused program
+			std::vector<var_t> expected_output;
+			const var_t expected_cost = vm::run(decoded, unit.input, expected_output, vm::Engine::Switch, false);
+			if (args.fusion)
+				vm::fuse(decoded);
+			cost = vm::run(decoded, unit.input, result.output, args.engine, args.fast_forward);
+			if (cost != expected_cost || result.output != expected_output)
+				throw std::runtime_error(std::format("validation failed: cost {} (expected {}), {} outputs (expected {})", cost, expected_cost, result.output.size(), expected_output.size()));
+		}
+		else
+		{
+			if (args.fusion)
+				vm::fuse(decoded);
+			cost = vm::run(decoded, unit.input, result.output, args.engine, args.fast_forward);
+		}
+
+		if (cost < 0)
+			throw std::runtime_error("READ past the end of the input");
+		result.new_cost = static_cast<uint64_t>(cost);
+	}
+	catch (const std::exception& e) {
+		result.compilation_success = false;
+		result.runtime_error = true;
+		result.error_message = "Runtime error: " + std::string(e.what());
+		result.new_cost = -1;
+		return result;
+	}
+
+	// the result stands either way, a failed store only costs the next run a recompilation
+	if (key)
+	{
+		try {
+			cache->store(*key, unit, result, output.path());
+		}
+		catch (const std::exception& e) {
+			KE_LOGWARNING("could not cache the result of {}: {}", unit.lang_filename.string(), e.what());
+		}
+	}
+
+	return result;
+}
+
+std::vector<BenchmarkResult> runBenchmarks(const Config& config, const Arguments& args, const std::vector<BenchmarkUnit>& units)
+{
+	std::vector<BenchmarkResult> results(units.size());
+	std::atomic<size_t> next = 0;
+
+	std::optional<ResultCache> cache;
+	if (args.cache)
+		cache = ResultCache::open(config.compiled_dir / "cache", "." / config.compiler_exe_path);
+
+	// every worker writes only its own slots, so the order does not depend on scheduling
+	auto worker = [&]() {
+		for (size_t i = next++; i < units.size(); i = next++)
+			results[i] = runBenchmark(config, args, units[i], cache ? &*cache : nullptr);
+	};
+
+	const size_t jobs = std::clamp<size_t>(args.jobs, 1, std::max<size_t>(units.size(), 1));
+	{
+		std::vector<std::jthread> workers;
+		for (size_t i = 1; i < jobs; i++)
+			workers.emplace_back(worker);
+		worker();
+	}
+
+	return results;
+}
+
+uint64_t countInstructions(const std::filesystem::path& asm_file)
+{
+	const auto program = vm::loadProgram(asm_file);
+	if (!program)
+		throw std::runtime_error(program.error().describe());
+	return program->code.size();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include "../input/struct.hpp"
+#include "../input/argparser.hpp"
+#include "cache.hpp"
+
+
+/**
+ * @brief Compiles a single benchmark and runs it on the VM.
+ *
+ * @details
+ * Compilation and runtime errors are reported in the result, never thrown.
+ * With a cache, an unchanged benchmark is answered from it and successful results are stored;
+ * `--validate` always compiles and runs.
+ */
+BenchmarkResult runBenchmark(const Config& config, const Arguments& args, const BenchmarkUnit& unit, const ResultCache* cache = nullptr);
+
+/**
+ * @brief Runs every benchmark on a pool of `args.jobs` workers.
+ *
+ * @details
+ * Each worker takes the next benchmark, compiles it and runs it, so compilation of one benchmark
+ * overlaps with VM execution of the others. Results are returned in the order of `units`.
+ * The result cache lives in `<compiled-dir>/cache` unless `--no-cache` is given.
+ */
+std::vector<BenchmarkResult> runBenchmarks(const Config& config, const Arguments& args, const std::vector<BenchmarkUnit>& units);
+
+// number of instructions in a compiled .mr file; throws std::runtime_error if the VM cannot load it
+uint64_t countInstructions(const std::filesystem::path& asm_file);
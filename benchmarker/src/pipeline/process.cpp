@@ -0,0 +1,99 @@
+#include "process.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <poll.h>
+#include <spawn.h>
+#include <stdexcept>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <KEUL/KEUL.hpp>
+
+extern char** environ;
+
+
+namespace
+{
+	double microseconds(const timeval& time)
+	{
+		return time.tv_sec * 1e6 + time.tv_usec;
+	}
+
+	// waits until `pid` exits or `timeout` passes, and kills it in the latter case; true if it was killed.
+	// The pidfd stays valid until the child is reaped, so an exit before pidfd_open is not missed.
+	bool killAfter(const pid_t pid, const std::chrono::milliseconds timeout)
+	{
+		const int pidfd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+		if (pidfd < 0)
+			return false;
+
+		const auto deadline = std::chrono::steady_clock::now() + timeout;
+		pollfd exited { .fd = pidfd, .events = POLLIN, .revents = 0 };
+		int ready;
+		do {
+			const auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+			ready = poll(&exited, 1, static_cast<int>(std::max<std::chrono::milliseconds::rep>(left.count(), 0)));
+		} while (ready == -1 && errno == EINTR);
+		close(pidfd);
+
+		if (ready != 0)
+			return false;
+		kill(pid, SIGKILL);
+		return true;
+	}
+}
+
+
+ProcessResult runProcess(const std::vector<std::string>& command, const std::filesystem::path& output, const std::chrono::milliseconds timeout)
+{
+	std::vector<char*> argv;
+	for (const std::string& arg : command)
+		argv.push_back(const_cast<char*>(arg.c_str()));
+	argv.push_back(nullptr);
+
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+	posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+	ke::Clock clock;
+	clock.start();
+
+	pid_t pid;
+	const int error = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+	posix_spawn_file_actions_destroy(&actions);
+	if (error != 0)
+		throw std::runtime_error(std::format("could not start '{}': {}", command[0], std::strerror(error)));
+
+	const bool timed_out = timeout.count() > 0 && killAfter(pid, timeout);
+	int status = 0;
+	rusage usage {};
+	while (wait4(pid, &status, 0, &usage) == -1 && errno == EINTR);
+	const double wall = static_cast<double>(clock.stop());
+
+	// also works for an in-memory output (/proc/<pid>/fd/<n>)
+	std::error_code size_error;
+	const uintmax_t output_bytes = output.empty() ? 0 : std::filesystem::file_size(output, size_error);
+
+	return ProcessResult {
+		.returncode = WIFEXITED(status) ? WEXITSTATUS(status) : -WTERMSIG(status),
+		.timed_out = timed_out,
+		.usage = ProcessUsage {
+			.wall_us = wall,
+			.user_us = microseconds(usage.ru_utime),
+			.sys_us = microseconds(usage.ru_stime),
+			.max_rss_kb = static_cast<uint64_t>(usage.ru_maxrss),
+			.minor_faults = static_cast<uint64_t>(usage.ru_minflt),
+			.major_faults = static_cast<uint64_t>(usage.ru_majflt),
+			.voluntary_switches = static_cast<uint64_t>(usage.ru_nvcsw),
+			.involuntary_switches = static_cast<uint64_t>(usage.ru_nivcsw),
+			.output_bytes = size_error ? 0 : static_cast<uint64_t>(output_bytes),
+		},
+	};
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../input/struct.hpp"
+
+
+struct ProcessResult
+{
+	int returncode;		// exit status, or -signal if the process was killed
+	bool timed_out;		// killed with SIGKILL after running longer than the timeout
+	ProcessUsage usage;
+};
+
+/**
+ * @brief Runs a command to completion with stdout and stderr discarded, and collects its resource usage.
+ *
+ * @details
+ * Unlike getrusage(RUSAGE_CHILDREN), the numbers belong to this process (and whatever it waited for)
+ * only, so they stay exact while other workers run their own compilers.
+ * Throws std::runtime_error if the process cannot be started.
+ * @param output	file the command writes; its size afterwards is reported as `output_bytes` (0 if not given)
+ * @param timeout	wall-clock limit, after which the process is killed; none if zero
+ */
+ProcessResult runProcess(const std::vector<std::string>& command, const std::filesystem::path& output = {}, std::chrono::milliseconds timeout = {});
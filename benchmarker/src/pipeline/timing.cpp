@@ -0,0 +1,210 @@
+#include "timing.hpp"
+#include "process.hpp"
+#include "output.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <KEUL/KEUL.hpp>
+
+
+namespace
+{
+	constexpr double significance = 0.01;
+	constexpr double min_slowdown = 1.05;
+
+	// up to this many samples per side and without ties, p-values come from the exact distribution of U
+	constexpr size_t exact_limit = 20;
+
+	double median(std::vector<double> sorted)
+	{
+		const size_t n = sorted.size();
+		return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+	}
+
+	// P(U >= u) when both samples come from the same distribution, counting every ordering of the pooled samples
+	double exactUpperTail(const size_t n1, const size_t n2, const size_t u)
+	{
+		// counts[a][v]: orderings of a reference and b candidate samples with U = v, for the current b;
+		// the largest sample is either a reference (U unchanged) or a candidate (larger than all a references)
+		std::vector<std::vector<double>> counts(n1 + 1, std::vector<double>(n1 * n2 + 1, 0));
+		for (size_t a = 0; a <= n1; a++)
+			counts[a][0] = 1;
+
+		for (size_t b = 1; b <= n2; b++)
+		{
+			std::vector<std::vector<double>> next(n1 + 1, std::vector<double>(n1 * n2 + 1, 0));
+			next[0][0] = 1;
+			for (size_t a = 1; a <= n1; a++)
+			{
+				for (size_t v = 0; v <= a * b; v++)
+					next[a][v] = next[a - 1][v] + (v >= a ? counts[a][v - a] : 0);
+			}
+			counts = std::move(next);
+		}
+
+		double tail = 0, total = 0;
+		for (size_t v = 0; v <= n1 * n2; v++)
+		{
+			total += counts[n1][v];
+			if (v >= u)
+				tail += counts[n1][v];
+		}
+		return tail / total;
+	}
+
+	// the smallest p-value any outcome can reach: all candidates above all references
+	double minimumPValue(const size_t n1, const size_t n2)
+	{
+		double orderings = 1;
+		for (size_t k = 1; k <= n1; k++)
+			orderings = orderings * (n2 + k) / k;
+		return 1 / orderings;
+	}
+}
+
+
+TimeStats summarize(std::vector<double> samples)
+{
+	if (samples.empty())
+		return TimeStats { 0, 0, 0, 0 };
+
+	std::sort(samples.begin(), samples.end());
+	const double mid = median(samples);
+
+	std::vector<double> deviations;
+	deviations.reserve(samples.size());
+	for (const double sample : samples)
+		deviations.push_back(std::abs(sample - mid));
+	std::sort(deviations.begin(), deviations.end());
+
+	const size_t p90_rank = static_cast<size_t>(std::ceil(0.9 * samples.size()));
+
+	return TimeStats {
+		.min = samples.front(),
+		.median = mid,
+		.p90 = samples[std::max<size_t>(p90_rank, 1) - 1],
+		.mad = median(deviations),
+	};
+}
+
+double mannWhitneyGreater(const std::vector<double>& reference, const std::vector<double>& candidate)
+{
+	const double n1 = reference.size();
+	const double n2 = candidate.size();
+	if (n1 == 0 || n2 == 0)
+		return 1;
+
+	// rank the pooled samples, ties get their average rank
+	std::vector<std::pair<double, bool>> pooled;	// (value, from candidate)
+	for (const double x : reference)
+		pooled.emplace_back(x, false);
+	for (const double x : candidate)
+		pooled.emplace_back(x, true);
+	std::sort(pooled.begin(), pooled.end());
+
+	double candidate_ranks = 0;
+	double tie_term = 0;
+	for (size_t i = 0; i < pooled.size(); )
+	{
+		size_t j = i;
+		while (j < pooled.size() && pooled[j].first == pooled[i].first)
+			j++;
+		const double rank = (i + 1 + j) / 2.0;
+		for (size_t k = i; k < j; k++)
+		{
+			if (pooled[k].second)
+				candidate_ranks += rank;
+		}
+		const double ties = j - i;
+		tie_term += ties * ties * ties - ties;
+		i = j;
+	}
+
+	const double n = n1 + n2;
+	const double u = candidate_ranks - n2 * (n2 + 1) / 2;
+	if (tie_term == 0 && n1 <= exact_limit && n2 <= exact_limit)
+		return exactUpperTail(reference.size(), candidate.size(), static_cast<size_t>(u));
+
+	const double mean = n1 * n2 / 2;
+	const double variance = n1 * n2 / 12 * ((n + 1) - tie_term / (n * (n - 1)));
+	if (variance <= 0)
+		return 1;
+
+	// continuity-corrected z, upper tail
+	const double z = (u - mean - 0.5) / std::sqrt(variance);
+	return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+void timeCompilations(const Config& config, const Arguments& args, const std::vector<BenchmarkUnit>& units, std::vector<BenchmarkResult>& results)
+{
+	const std::string compiler = std::filesystem::path("." / config.compiler_exe_path).string();
+
+	// with too few samples on either side even the clearest slowdown stays above the significance level
+	size_t untestable = 0;
+	for (size_t i = 0; i < units.size(); i++)
+	{
+		const size_t reference_runs = units[i].reference_compile_wall.size();
+		if (results[i].compilation_success && reference_runs > 0 && minimumPValue(reference_runs, args.timing_runs) >= significance)
+			untestable++;
+	}
+	if (untestable > 0)
+		KE_LOGWARNING("{} benchmark(s) cannot be flagged as SLOWER: {} timed runs against their reference samples cannot reach p < {}; use at least 5 runs on both sides",
+			untestable, args.timing_runs, significance);
+
+	for (size_t i = 0; i < units.size(); i++)
+	{
+		const BenchmarkUnit& unit = units[i];
+		BenchmarkResult& result = results[i];
+		if (!result.compilation_success)
+			continue;
+
+		const CompilerOutput output(unit.asm_filename, args.in_memory);
+
+		// a compiler that cannot be started anymore counts as failed, like in the shell
+		auto compile = [&]() {
+			try {
+				return runProcess({compiler, unit.lang_filename.string(), output.path().string()});
+			}
+			catch (const std::exception&) {
+				return ProcessResult { .returncode = 127, .timed_out = false, .usage = {} };
+			}
+		};
+
+		for (unsigned w = 0; w < args.warmup_runs; w++)
+			compile();
+
+		std::vector<double> wall, user, sys;
+		ke::LoopBenchmark benchmark(unit.lang_filename.filename().string(), ke::TimeUnit::microseconds);
+		for (unsigned k = 0; k < args.timing_runs; k++)
+		{
+			benchmark.startIteration();
+			const ProcessResult process = compile();
+			wall.push_back(static_cast<double>(benchmark.endIteration()));
+
+			if (process.returncode != 0)
+			{
+				result.compilation_success = false;
+				result.error_message = "Compiler returned code: " + std::to_string(process.returncode) + " while timing";
+				break;
+			}
+			user.push_back(process.usage.user_us);
+			sys.push_back(process.usage.sys_us);
+		}
+		benchmark.stop();
+
+		if (!result.compilation_success)
+			continue;
+
+		CompileTiming timing {
+			.wall_samples = wall,
+			.wall = summarize(wall),
+			.user = summarize(user),
+			.sys = summarize(sys),
+			.p_value = mannWhitneyGreater(unit.reference_compile_wall, wall),
+			.regression = false,
+		};
+		timing.regression = timing.p_value < significance
+			&& timing.wall.median > summarize(unit.reference_compile_wall).median * min_slowdown;
+		result.timing = std::move(timing);
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+#include "../input/struct.hpp"
+#include "../input/argparser.hpp"
+
+
+// min, median, p90 (nearest rank) and MAD of the samples; all zero for an empty vector
+TimeStats summarize(std::vector<double> samples);
+
+/**
+ * @brief One-sided Mann-Whitney U test: exact for up to 20 samples per side without ties,
+ * otherwise the normal approximation with tie correction.
+ *
+ * @return p-value of the hypothesis that `candidate` tends to be larger than `reference`
+ */
+double mannWhitneyGreater(const std::vector<double>& reference, const std::vector<double>& candidate);
+
+/**
+ * @brief Times the compiler on every successfully compiled benchmark.
+ *
+ * @details
+ * Runs `args.warmup_runs` untimed and `args.timing_runs` timed compilations per benchmark, one
+ * process at a time so the measurements do not compete for the CPU. Wall time comes from
+ * ke::LoopBenchmark, user and sys time from wait4() on the compiler process.
+ * A benchmark is flagged as a regression only if the new wall times are significantly larger
+ * than `reference_compile_wall` (p < 0.01) and the median grew by more than 5%.
+ */
+void timeCompilations(const Config& config, const Arguments& args, const std::vector<BenchmarkUnit>& units, std::vector<BenchmarkResult>& results);
@@ -0,0 +1,337 @@
+#include "report.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <print>
+#include <nlohmann/json.hpp>
+#include <KEUL/KEUL.hpp>
+
+#include "../input/jsonparser.hpp"
+#include "../fuzz/fuzz.hpp"
+
+using json = nlohmann::json;
+
+
+namespace
+{
+	constexpr uint64_t no_reference = std::numeric_limits<uint64_t>::max();
+
+	std::string status(const BenchmarkResult& result)
+	{
+		if (result.compilation_success)
+			return "ok";
+		return result.runtime_error ? "runtime-error" : "compile-error";
+	}
+
+	std::optional<double> change(const BenchmarkResult& result)
+	{
+		if (!result.compilation_success || result.reference_cost == no_reference || result.reference_cost == 0)
+			return std::nullopt;
+		return (static_cast<double>(result.new_cost) / result.reference_cost - 1) * 100;
+	}
+
+	void writeJson(std::ostream& out, const std::vector<BenchmarkResult>& results)
+	{
+		json data = json::array();
+		for (const auto& result : results)
+		{
+			const auto delta = change(result);
+			json entry = {
+				{"file", result.filename.filename().string()},
+				{"status", status(result)},
+				{"error", result.error_message},
+				{"cached", result.cached},
+				{"reference-cost", result.reference_cost == no_reference ? json(nullptr) : json(result.reference_cost)},
+				{"cost", result.compilation_success ? json(result.new_cost) : json(nullptr)},
+				{"change-percent", delta ? json(*delta) : json(nullptr)},
+				{"tolerance-percent", result.tolerance},
+				{"regression", isRegression(result)},
+				{"instructions", result.instruction_count},
+				{"output", result.output},
+			};
+			if (result.timing)
+				entry["compile-timing"] = *result.timing;
+			if (result.compiler_usage)
+				entry["compiler-usage"] = *result.compiler_usage;
+			data.push_back(std::move(entry));
+		}
+
+		std::println(out, "{}", data.dump(4));
+	}
+
+	std::string csvField(const std::string& field)
+	{
+		if (field.find_first_of(",\"\n") == std::string::npos)
+			return field;
+
+		std::string quoted = "\"";
+		for (const char c : field)
+		{
+			if (c == '"')
+				quoted += '"';
+			quoted += c;
+		}
+		return quoted + '"';
+	}
+
+	void writeCsv(std::ostream& out, const std::vector<BenchmarkResult>& results)
+	{
+		std::println(out, "file,status,reference_cost,cost,change_percent,tolerance_percent,regression,instructions,cached,compile_wall_ms,compiler_max_rss_kb,error");
+		for (const auto& result : results)
+		{
+			const auto delta = change(result);
+			std::println(out, "{},{},{},{},{},{},{},{},{},{},{},{}",
+				csvField(result.filename.filename().string()),
+				status(result),
+				result.reference_cost == no_reference ? "" : std::to_string(result.reference_cost),
+				result.compilation_success ? std::to_string(result.new_cost) : "",
+				delta ? std::format("{:.3f}", *delta) : "",
+				result.tolerance,
+				isRegression(result) ? 1 : 0,
+				result.instruction_count,
+				result.cached ? 1 : 0,
+				result.timing ? std::format("{:.3f}", result.timing->wall.median / 1000)
+					: result.compiler_usage ? std::format("{:.3f}", result.compiler_usage->wall_us / 1000) : "",
+				result.compiler_usage ? std::to_string(result.compiler_usage->max_rss_kb) : "",
+				csvField(result.error_message)
+			);
+		}
+	}
+
+	json optional(const std::optional<double>& value)
+	{
+		return value ? json(*value) : json(nullptr);
+	}
+
+	void writeScalingJson(std::ostream& out, const std::vector<ScalingSeries>& series)
+	{
+		json data = json::array();
+		for (const auto& s : series)
+		{
+			json points = json::array();
+			for (const auto& point : s.points)
+			{
+				points.push_back({
+					{"size", point.size},
+					{"status", point.success ? "ok" : "compile-error"},
+					{"error", point.error_message},
+					{"compile-us", point.compile_us},
+					{"max-rss-kb", point.max_rss_kb},
+					{"instructions", point.instructions},
+				});
+			}
+			data.push_back({
+				{"family", s.family},
+				{"time-exponent", optional(s.time_exponent)},
+				{"instruction-exponent", optional(s.instruction_exponent)},
+				{"super-linear", s.super_linear},
+				{"points", std::move(points)},
+			});
+		}
+
+		std::println(out, "{}", data.dump(4));
+	}
+
+	void writeScalingCsv(std::ostream& out, const std::vector<ScalingSeries>& series)
+	{
+		auto exponent = [](const std::optional<double>& value) { return value ? std::format("{:.3f}", *value) : std::string(); };
+
+		std::println(out, "family,size,status,compile_us,max_rss_kb,instructions,time_exponent,instruction_exponent,super_linear,error");
+		for (const auto& s : series)
+		{
+			for (const auto& point : s.points)
+			{
+				std::println(out, "{},{},{},{:.1f},{},{},{},{},{},{}",
+					s.family,
+					point.size,
+					point.success ? "ok" : "compile-error",
+					point.compile_us,
+					point.max_rss_kb,
+					point.instructions,
+					exponent(s.time_exponent),
+					exponent(s.instruction_exponent),
+					s.super_linear ? 1 : 0,
+					csvField(point.error_message)
+				);
+			}
+		}
+	}
+
+	void writeFuzzJson(std::ostream& out, const FuzzReport& report)
+	{
+		json findings = json::array();
+		for (const auto& finding : report.findings)
+		{
+			findings.push_back({
+				{"seed", finding.seed},
+				{"kind", fuzzKindName(finding.kind)},
+				{"message", finding.message},
+				{"file", finding.file.string()},
+				{"commands", finding.commands},
+				{"reduced-commands", finding.reduced_commands},
+			});
+		}
+		const json data = {
+			{"cases", report.cases},
+			{"valid", report.valid},
+			{"outlier-ratio", report.outlier_ratio},
+			{"findings", std::move(findings)},
+		};
+
+		std::println(out, "{}", data.dump(4));
+	}
+
+	void writeFuzzCsv(std::ostream& out, const FuzzReport& report)
+	{
+		std::println(out, "seed,kind,commands,reduced_commands,file,message");
+		for (const auto& finding : report.findings)
+		{
+			std::println(out, "{},{},{},{},{},{}",
+				finding.seed,
+				fuzzKindName(finding.kind),
+				finding.commands,
+				finding.reduced_commands,
+				csvField(finding.file.string()),
+				csvField(finding.message)
+			);
+		}
+	}
+
+	// runs `write` on the file, or on stdout for "-"
+	bool writeTo(const std::string& target, auto write)
+	{
+		std::ofstream file;
+		if (target != "-")
+		{
+			file.open(target);
+			if (!file)
+			{
+				KE_LOGERROR("could not write to '{}'", target);
+				return false;
+			}
+		}
+		std::ostream& out = target == "-" ? std::cout : file;
+
+		write(out);
+		return static_cast<bool>(out.flush());
+	}
+}
+
+
+std::optional<ExportFormat> exportFormatFromString(const std::string_view name)
+{
+	if (name == "json")
+		return ExportFormat::Json;
+	if (name == "csv")
+		return ExportFormat::Csv;
+	return std::nullopt;
+}
+
+bool isRegression(const BenchmarkResult& result)
+{
+	if (!result.compilation_success || result.reference_cost == no_reference)
+		return false;
+	return static_cast<double>(result.new_cost) > static_cast<double>(result.reference_cost) * (1 + result.tolerance / 100);
+}
+
+int ciExitCode(const std::vector<BenchmarkResult>& results)
+{
+	int code = CiSuccess;
+	for (const auto& result : results)
+	{
+		if (isRegression(result))
+			code |= CiCostRegression;
+		else if (!result.compilation_success)
+			code |= result.runtime_error ? CiRuntimeError : CiCompileFailure;
+	}
+	return code;
+}
+
+bool exportResults(const std::string& target, const ExportFormat format, const std::vector<BenchmarkResult>& results)
+{
+	return writeTo(target, [&](std::ostream& out) {
+		switch (format)
+		{
+		case ExportFormat::Json:
+			writeJson(out, results);
+			break;
+		case ExportFormat::Csv:
+			writeCsv(out, results);
+			break;
+		}
+	});
+}
+
+int ciExitCode(const std::vector<ScalingSeries>& series)
+{
+	int code = CiSuccess;
+	for (const auto& s : series)
+	{
+		if (s.super_linear)
+			code |= CiSuperLinear;
+		if (std::any_of(s.points.begin(), s.points.end(), [](const ScalingPoint& p) { return !p.success; }))
+			code |= CiCompileFailure;
+	}
+	return code;
+}
+
+bool exportScaling(const std::string& target, const ExportFormat format, const std::vector<ScalingSeries>& series)
+{
+	return writeTo(target, [&](std::ostream& out) {
+		switch (format)
+		{
+		case ExportFormat::Json:
+			writeScalingJson(out, series);
+			break;
+		case ExportFormat::Csv:
+			writeScalingCsv(out, series);
+			break;
+		}
+	});
+}
+
+int ciExitCode(const FuzzReport& report)
+{
+	int code = CiSuccess;
+	for (const auto& finding : report.findings)
+	{
+		switch (finding.kind)
+		{
+		case FuzzKind::Crash:
+		case FuzzKind::CompileTimeout:
+		case FuzzKind::Rejected:
+		case FuzzKind::InvalidProgram:
+			code |= CiCompileFailure;
+			break;
+		case FuzzKind::RuntimeError:
+		case FuzzKind::StepLimit:
+			code |= CiRuntimeError;
+			break;
+		case FuzzKind::WrongOutput:
+			code |= CiWrongOutput;
+			break;
+		case FuzzKind::CostOutlier:
+			code |= CiCostRegression;
+			break;
+		}
+	}
+	return code;
+}
+
+bool exportFuzz(const std::string& target, const ExportFormat format, const FuzzReport& report)
+{
+	return writeTo(target, [&](std::ostream& out) {
+		switch (format)
+		{
+		case ExportFormat::Json:
+			writeFuzzJson(out, report);
+			break;
+		case ExportFormat::Csv:
+			writeFuzzCsv(out, report);
+			break;
+		}
+	});
+}
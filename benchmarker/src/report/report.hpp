@@ -0,0 +1,50 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../input/struct.hpp"
+
+
+enum class ExportFormat
+{
+	Json,
+	Csv,
+};
+
+std::optional<ExportFormat> exportFormatFromString(std::string_view name);
+
+// exit status of --ci; the flags are or'ed, 1 stays reserved for usage and configuration errors
+enum CiExitCode : int
+{
+	CiSuccess = 0,
+	CiCostRegression = 1 << 1,
+	CiCompileFailure = 1 << 2,
+	CiRuntimeError = 1 << 3,
+	CiSuperLinear = 1 << 4,		// --scaling only
+	CiWrongOutput = 1 << 5,		// --fuzz only
+};
+
+// successful, with a known reference cost, and more expensive than the tolerance allows
+bool isRegression(const BenchmarkResult& result);
+
+int ciExitCode(const std::vector<BenchmarkResult>& results);
+int ciExitCode(const std::vector<ScalingSeries>& series);
+// crashes and rejected programs are compile failures, cost outliers are cost regressions
+int ciExitCode(const FuzzReport& report);
+
+/**
+ * @brief Writes every result (costs, outputs, errors, compiler timing and resource usage).
+ *
+ * @param target	file path, or "-" for stdout
+ * @return false if the file could not be written
+ */
+bool exportResults(const std::string& target, ExportFormat format, const std::vector<BenchmarkResult>& results);
+
+// every measured size of every family and the fitted exponents; CSV has one row per size
+bool exportScaling(const std::string& target, ExportFormat format, const std::vector<ScalingSeries>& series);
+
+// one entry per finding, with the path of its reduced program
+bool exportFuzz(const std::string& target, ExportFormat format, const FuzzReport& report);
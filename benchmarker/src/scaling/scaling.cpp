@@ -0,0 +1,159 @@
+#include "scaling.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <format>
+#include <system_error>
+
+#include "../pipeline/pipeline.hpp"
+#include "../pipeline/process.hpp"
+#include "../pipeline/output.hpp"
+#include "../pipeline/timing.hpp"
+
+#include "../../../generator/generator.hpp"
+
+
+namespace
+{
+	constexpr double super_linear_exponent = 1.25;
+	constexpr double min_growth = 2.0;
+	constexpr unsigned default_runs = 3;
+
+	bool superLinear(const std::optional<double>& exponent, const std::vector<ScalingPoint>& points, auto metric)
+	{
+		if (!exponent || *exponent <= super_linear_exponent)
+			return false;
+		// a flat curve fits any exponent to its noise
+		return metric(points.back()) >= min_growth * std::max(metric(points.front()), 1.0);
+	}
+
+	ScalingPoint measure(const std::string& compiler, const std::filesystem::path& source, const std::filesystem::path& target, size_t size, const Arguments& args)
+	{
+		ScalingPoint point { .size = size, .success = true, .error_message = "", .compile_us = 0, .max_rss_kb = 0, .instructions = 0 };
+
+		const unsigned runs = args.timing_runs > 0 ? args.timing_runs : default_runs;
+		const CompilerOutput output(target, args.in_memory);
+		std::vector<double> wall;
+		for (unsigned k = 0; k < args.warmup_runs + runs; k++)
+		{
+			ProcessResult process;
+			try {
+				process = runProcess({compiler, source.string(), output.path().string()});
+			}
+			catch (const std::exception& e) {
+				point.success = false;
+				point.error_message = e.what();
+				return point;
+			}
+
+			if (process.returncode != 0)
+			{
+				point.success = false;
+				point.error_message = "Compiler returned code: " + std::to_string(process.returncode);
+				return point;
+			}
+
+			point.max_rss_kb = std::max(point.max_rss_kb, process.usage.max_rss_kb);
+			if (k >= args.warmup_runs)
+				wall.push_back(process.usage.wall_us);
+		}
+		point.compile_us = summarize(wall).median;
+
+		try {
+			point.instructions = countInstructions(output.path());
+		}
+		catch (const std::exception& e) {
+			point.success = false;
+			point.error_message = "Invalid program: " + std::string(e.what());
+		}
+		return point;
+	}
+}
+
+
+std::optional<double> fitExponent(const std::vector<double>& sizes, const std::vector<double>& values)
+{
+	if (sizes.size() != values.size() || sizes.size() < 3)
+		return std::nullopt;
+
+	const double base = values.front();
+	std::vector<std::pair<double, double>> logs;
+	for (size_t i = sizes.size() / 2; i < sizes.size(); i++)
+	{
+		const double excess = values[i] - base;
+		if (excess > 0 && sizes[i] > 0)
+			logs.emplace_back(std::log(sizes[i]), std::log(excess));
+	}
+	if (logs.size() < 2)
+		return std::nullopt;
+
+	double mean_x = 0, mean_y = 0;
+	for (const auto& [x, y] : logs)
+	{
+		mean_x += x;
+		mean_y += y;
+	}
+	mean_x /= logs.size();
+	mean_y /= logs.size();
+
+	double sxy = 0, sxx = 0;
+	for (const auto& [x, y] : logs)
+	{
+		sxy += (x - mean_x) * (y - mean_y);
+		sxx += (x - mean_x) * (x - mean_x);
+	}
+	if (sxx == 0)
+		return std::nullopt;
+	return sxy / sxx;
+}
+
+std::vector<ScalingSeries> runScaling(const Config& config, const Arguments& args)
+{
+	const std::string compiler = std::filesystem::path("." / config.compiler_exe_path).string();
+	const std::filesystem::path dir = config.compiled_dir / "scaling";
+	std::error_code error;
+	std::filesystem::create_directories(dir, error);
+
+	std::vector<ScalingSeries> all;
+	for (const gen::Family family : gen::families)
+	{
+		ScalingSeries series { .family = std::string(gen::familyName(family)), .points = {}, .time_exponent = {}, .instruction_exponent = {}, .super_linear = false };
+
+		for (size_t size = 1; size <= std::max<size_t>(args.scaling_max, 1); size *= 2)
+		{
+			const std::string name = std::format("{}-{}", series.family, size);
+			const std::filesystem::path source = dir / (name + ".imp");
+			const std::filesystem::path target = dir / (name + ".mr");
+
+			{
+				std::ofstream ofstr(source);
+				ofstr << gen::generateProgram(family, size);
+			}
+
+			series.points.push_back(measure(compiler, source, target, size, args));
+			// larger programs only fail the same way, and more slowly
+			if (!series.points.back().success)
+				break;
+		}
+
+		if (std::all_of(series.points.begin(), series.points.end(), [](const ScalingPoint& p) { return p.success; }))
+		{
+			std::vector<double> sizes, times, instructions;
+			for (const auto& point : series.points)
+			{
+				sizes.push_back(static_cast<double>(point.size));
+				times.push_back(point.compile_us);
+				instructions.push_back(static_cast<double>(point.instructions));
+			}
+			series.time_exponent = fitExponent(sizes, times);
+			series.instruction_exponent = fitExponent(sizes, instructions);
+			series.super_linear =
+				superLinear(series.time_exponent, series.points, [](const ScalingPoint& p) { return p.compile_us; })
+				|| superLinear(series.instruction_exponent, series.points, [](const ScalingPoint& p) { return static_cast<double>(p.instructions); });
+		}
+
+		all.push_back(std::move(series));
+	}
+	return all;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "../input/struct.hpp"
+#include "../input/argparser.hpp"
+
+
+/**
+ * @brief Fits `values ~ c + a * sizes^k` and returns k.
+ *
+ * @details
+ * The value at the smallest size is taken as the constant part (process start-up, the program
+ * skeleton), the rest is fitted by least squares on a log-log scale over the upper half of the
+ * sizes, where the asymptotic behaviour dominates. That takes at least three sizes; nothing is returned with
+ * fewer, or with less than two usable points.
+ */
+std::optional<double> fitExponent(const std::vector<double>& sizes, const std::vector<double>& values);
+
+/**
+ * @brief Generates every program family at sizes 1, 2, 4, ..., `args.scaling_max` (at least 4) and compiles each one.
+ *
+ * @details
+ * The programs are written to `<compiled-dir>/scaling`. Every size is compiled `args.warmup_runs`
+ * times untimed and `args.timing_runs` times timed (3 without --time-compiler), one process at a time.
+ * A family is super-linear if the compile time or the instruction count grows with an exponent above
+ * 1.25 and at least doubles over the measured range.
+ */
+std::vector<ScalingSeries> runScaling(const Config& config, const Arguments& args);
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <set>
 #include <print>
+#include <format>
 #include <string>
 #include <iostream>
 #include <ftxui/screen/screen.hpp>
@@ -14,7 +15,7 @@
 namespace tui
 {
 
-	ftxui::Element createCostGauge(const std::string& filename, uint64_t ref_cost, uint64_t new_cost, uint64_t max_cost, int screen_width)
+	ftxui::Element createCostGauge(const std::string& filename, uint64_t ref_cost, uint64_t new_cost, uint64_t max_cost, int screen_width, ftxui::Element details)
 	{
 		const int width = std::max(20, screen_width - 60); // Leave space for labels and borders, minimum 20
 		const int halfwidth = width / 2;
@@ -48,10 +49,46 @@ namespace tui
 				ftxui::text(" ") | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 2),
 				gauge_bar
 			}),
+			details,
 			ftxui::separator()
 			});
 	}
 
+	ftxui::Element createTimingRow(const CompileTiming& timing)
+	{
+		// microseconds -> "median ±MAD (min .. p90) ms"
+		auto stats = [](const std::string& label, const TimeStats& s) {
+			return ftxui::text(std::format(" {}: {:.2f} ±{:.2f} ({:.2f} .. {:.2f}) ms", label, s.median / 1000, s.mad / 1000, s.min / 1000, s.p90 / 1000))
+				| ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 44);
+		};
+
+		return ftxui::hbox({
+			ftxui::text("compiler") | ftxui::color(ftxui::Color::GrayDark) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 30),
+			stats("wall", timing.wall),
+			stats("user", timing.user),
+			stats("sys", timing.sys),
+			timing.regression
+				? ftxui::text(std::format(" SLOWER (p = {:.4f})", timing.p_value)) | ftxui::color(ftxui::Color::Red) | ftxui::bold
+				: ftxui::text("")
+		});
+	}
+
+	ftxui::Element createUsageRow(const ProcessUsage& usage)
+	{
+		auto field = [](const std::string& content) {
+			return ftxui::text(content) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 26);
+		};
+
+		return ftxui::hbox({
+			ftxui::text("compiler resources") | ftxui::color(ftxui::Color::GrayDark) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 30),
+			field(std::format(" peak RSS: {:.1f} MiB", usage.max_rss_kb / 1024.0)),
+			field(std::format(" faults: {} / {} major", usage.minor_faults, usage.major_faults)),
+			field(std::format(" ctx sw: {} / {} invol.", usage.voluntary_switches, usage.involuntary_switches)),
+			field(std::format(" output: {:.1f} KiB", usage.output_bytes / 1024.0)),
+			field(std::format(" time: {:.2f} ms", usage.wall_us / 1000)),
+		});
+	}
+
 	bool showBenchmarkResults(std::vector<BenchmarkResult>& results)
 	{
 		// Find max cost for scaling
@@ -76,11 +113,15 @@ namespace tui
 			if (result.compilation_success)
 			{
 				gauge_element = createCostGauge(
-					result.filename.filename().string(),
+					result.filename.filename().string() + (result.cached ? " (cached)" : ""),
 					result.reference_cost,
 					result.new_cost,
 					max_cost,
-					screen_width
+					screen_width,
+					ftxui::vbox({
+						result.compiler_usage ? createUsageRow(*result.compiler_usage) : ftxui::emptyElement(),
+						result.timing ? createTimingRow(*result.timing) : ftxui::emptyElement(),
+					})
 				);
 			}
 			else
@@ -88,9 +129,10 @@ namespace tui
 				gauge_element = ftxui::vbox({
 					ftxui::hbox({
 						ftxui::text(result.filename.filename().string()) | ftxui::bold | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 20),
-						ftxui::text(" COMPILATION FAILED") | ftxui::color(ftxui::Color::Red),
+						ftxui::text(result.runtime_error ? " RUNTIME ERROR" : " COMPILATION FAILED") | ftxui::color(ftxui::Color::Red),
 						ftxui::text(" Error: " + result.error_message) | ftxui::color(ftxui::Color::Red)
 					}),
+					result.compiler_usage ? createUsageRow(*result.compiler_usage) : ftxui::emptyElement(),
 					ftxui::separator()
 				});
 			}
@@ -110,10 +152,16 @@ namespace tui
 		int within_budget = std::count_if(results.begin(), results.end(),
 			[](const BenchmarkResult& r) { return r.compilation_success && r.new_cost <= r.reference_cost; });
 
+		int slower = std::count_if(results.begin(), results.end(),
+			[](const BenchmarkResult& r) { return r.timing && r.timing->regression; });
+
 		auto summary = ftxui::hbox({
 			ftxui::text("Summary: ") | ftxui::bold,
 			ftxui::text(std::to_string(within_budget) + "/" + std::to_string(successful) + " within budget") |
-				ftxui::color(within_budget == successful ? ftxui::Color::Green : ftxui::Color::Yellow)
+				ftxui::color(within_budget == successful ? ftxui::Color::Green : ftxui::Color::Yellow),
+			slower > 0
+				? ftxui::text(", compiler significantly slower on " + std::to_string(slower)) | ftxui::color(ftxui::Color::Red)
+				: ftxui::text("")
 			});
 
 		auto summary_screen = ftxui::Screen::Create(ftxui::Dimension::Fit(summary));
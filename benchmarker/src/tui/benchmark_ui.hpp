@@ -8,8 +8,14 @@
 
 namespace tui {
 
-// Create a cost gauge element for a single benchmark result
-ftxui::Element createCostGauge(const std::string& filename, uint64_t ref_cost, uint64_t actual_cost, uint64_t max_cost, int screen_width);
+// Create a cost gauge element for a single benchmark result, `details` goes below the gauge
+ftxui::Element createCostGauge(const std::string& filename, uint64_t ref_cost, uint64_t actual_cost, uint64_t max_cost, int screen_width, ftxui::Element details = ftxui::emptyElement());
+
+// Create a row with compiler wall/user/sys time statistics
+ftxui::Element createTimingRow(const CompileTiming& timing);
+
+// Create a row with the resources (memory, faults, context switches, output) of one compiler run
+ftxui::Element createUsageRow(const ProcessUsage& usage);
 
 // Show the benchmark results interface and return whether user wants to override costs
 bool showBenchmarkResults(std::vector<BenchmarkResult>& results);
@@ -0,0 +1,63 @@
+#include "fuzz_ui.hpp"
+
+#include <format>
+#include <iostream>
+#include <print>
+#include <ftxui/screen/screen.hpp>
+
+#include "../fuzz/fuzz.hpp"
+
+namespace tui
+{
+
+	namespace
+	{
+		void print(const ftxui::Element& element)
+		{
+			auto screen = ftxui::Screen::Create(ftxui::Dimension::Fit(element));
+			ftxui::Render(screen, element);
+			screen.Print();
+			std::cout << std::endl;
+		}
+
+		ftxui::Color kindColor(const FuzzKind kind)
+		{
+			return kind == FuzzKind::CostOutlier ? ftxui::Color::Yellow : ftxui::Color::Red;
+		}
+	}
+
+
+	void showFuzzReport(const FuzzReport& report)
+	{
+		std::println();
+
+		for (const auto& finding : report.findings)
+		{
+			print(ftxui::vbox({
+				ftxui::hbox({
+					ftxui::text(std::format("seed {}", finding.seed)) | ftxui::bold | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 16),
+					ftxui::text(std::string(fuzzKindName(finding.kind))) | ftxui::color(kindColor(finding.kind)) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 18),
+					ftxui::text(finding.message),
+				}),
+				ftxui::hbox({
+					ftxui::text("reduced") | ftxui::color(ftxui::Color::GrayDark) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 16),
+					ftxui::text(std::format("{} -> {} commands", finding.commands, finding.reduced_commands)) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 26),
+					ftxui::text(finding.file.string()),
+				}),
+				ftxui::separator(),
+			}));
+		}
+
+		const auto summary = ftxui::hbox({
+			ftxui::text("Summary: ") | ftxui::bold,
+			ftxui::text(std::format("{} programs, {} valid, ", report.cases, report.valid)),
+			ftxui::text(std::format("{} findings", report.findings.size()))
+				| ftxui::color(report.findings.empty() ? ftxui::Color::Green : ftxui::Color::Red),
+			report.outlier_ratio > 0
+				? ftxui::text(std::format(", cost outliers above {:.1f} per operation", report.outlier_ratio))
+				: ftxui::text(", too few programs to find cost outliers"),
+		});
+		print(summary);
+	}
+
+} // namespace tui
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <ftxui/dom/elements.hpp>
+
+#include "../input/struct.hpp"
+
+namespace tui {
+
+// Print the number of programs tried and one row per finding with the path of its reduced program
+void showFuzzReport(const FuzzReport& report);
+
+} // namespace tui
@@ -0,0 +1,151 @@
+#include "history_ui.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <map>
+#include <print>
+#include <ftxui/screen/screen.hpp>
+
+namespace tui
+{
+
+	namespace
+	{
+		constexpr size_t sparkline_width = 32;
+
+		struct Series
+		{
+			std::vector<double> costs;
+			std::vector<double> compile_times;
+			uint64_t instructions = 0;
+			size_t runs = 0;
+			size_t failures = 0;
+		};
+
+		std::string date(const int64_t timestamp)
+		{
+			return std::format("{:%Y-%m-%d %H:%M}", std::chrono::sys_seconds(std::chrono::seconds(timestamp)));
+		}
+
+		void print(const ftxui::Element& element)
+		{
+			auto screen = ftxui::Screen::Create(ftxui::Dimension::Fit(element));
+			ftxui::Render(screen, element);
+			screen.Print();
+			std::cout << std::endl;
+		}
+	}
+
+
+	std::string sparkline(const std::vector<double>& values)
+	{
+		static const char* const bars[] = { "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█" };
+		if (values.empty())
+			return "";
+
+		const auto [low, high] = std::minmax_element(values.begin(), values.end());
+		std::string line;
+		for (const double value : values)
+		{
+			const double level = *high > *low ? (value - *low) / (*high - *low) : 0;
+			line += bars[std::clamp(static_cast<int>(level * 7 + 0.5), 0, 7)];
+		}
+		return line;
+	}
+
+	void showHistory(const std::vector<HistoryRecord>& records)
+	{
+		if (records.empty())
+		{
+			std::println("no benchmark history yet");
+			return;
+		}
+
+		// benchmarks in the order of their first appearance
+		std::vector<std::string> order;
+		std::map<std::string, Series> series;
+		for (const auto& record : records)
+		{
+			for (const auto& entry : record.entries)
+			{
+				auto [it, inserted] = series.try_emplace(entry.file);
+				if (inserted)
+					order.push_back(entry.file);
+
+				Series& s = it->second;
+				s.runs++;
+				if (!entry.success)
+				{
+					s.failures++;
+					continue;
+				}
+				s.costs.push_back(static_cast<double>(entry.cost));
+				s.instructions = entry.instructions;
+				if (!entry.cached && entry.compile_us > 0)
+					s.compile_times.push_back(entry.compile_us);
+			}
+		}
+
+		std::println("{} runs from {} to {}", records.size(), date(records.front().timestamp), date(records.back().timestamp));
+		std::println();
+
+		for (const auto& file : order)
+		{
+			const Series& s = series[file];
+
+			ftxui::Element cost = ftxui::text("no successful run") | ftxui::color(ftxui::Color::Red);
+			if (!s.costs.empty())
+			{
+				const double first = s.costs.front();
+				const double last = s.costs.back();
+				const double change = first > 0 ? (last / first - 1) * 100 : 0;
+				const auto recent = std::vector<double>(s.costs.end() - std::min(s.costs.size(), sparkline_width), s.costs.end());
+
+				cost = ftxui::hbox({
+					ftxui::text(std::format(" cost: {:.0f} -> {:.0f}", first, last)) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 34),
+					ftxui::text(std::format(" {:+.1f}% ", change))
+						| ftxui::color(change > 0 ? ftxui::Color::Red : change < 0 ? ftxui::Color::Green : ftxui::Color::White)
+						| ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 10),
+					ftxui::text(sparkline(recent)) | ftxui::color(ftxui::Color::Cyan) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, sparkline_width + 2),
+				});
+			}
+
+			const auto recent_compile = std::vector<double>(s.compile_times.end() - std::min<size_t>(s.compile_times.size(), 5), s.compile_times.end());
+
+			print(ftxui::hbox({
+				ftxui::text(file) | ftxui::bold | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 30),
+				ftxui::text(std::format(" {} runs", s.runs)) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 10),
+				cost,
+				ftxui::text(std::format(" {} instr.", s.instructions)) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 16),
+				ftxui::text(recent_compile.empty() ? "" : std::format(" compile: {:.2f} ms", summarize(recent_compile).median / 1000)),
+				s.failures > 0 ? ftxui::text(std::format(" {} failed", s.failures)) | ftxui::color(ftxui::Color::Red) : ftxui::text(""),
+			}));
+		}
+
+		const auto steps = findStepRegressions(records);
+		std::println();
+		if (steps.empty())
+		{
+			print(ftxui::text("no step regressions") | ftxui::color(ftxui::Color::Green));
+			return;
+		}
+
+		print(ftxui::text(std::format("{} step regressions:", steps.size())) | ftxui::bold | ftxui::color(ftxui::Color::Red));
+		for (const auto& step : steps)
+		{
+			const HistoryRecord& record = records[step.run];
+			const bool time = step.metric != "cost";
+			print(ftxui::hbox({
+				ftxui::text(step.file) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 30),
+				ftxui::text(time
+					? std::format(" {}: {:.2f} -> {:.2f} ms", step.metric, step.before / 1000, step.after / 1000)
+					: std::format(" {}: {:.0f} -> {:.0f}", step.metric, step.before, step.after)) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 42),
+				ftxui::text(step.before > 0 ? std::format(" {:+.1f}%", (step.after / step.before - 1) * 100) : "") | ftxui::color(ftxui::Color::Red) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 10),
+				ftxui::text(std::format(" run {} ({}), compiler {}", step.run + 1, date(record.timestamp), record.compiler.substr(0, 12))) | ftxui::color(ftxui::Color::GrayDark),
+			}));
+		}
+	}
+
+} // namespace tui
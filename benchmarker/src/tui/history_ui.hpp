@@ -0,0 +1,16 @@
+#pragma once
+
+#include <vector>
+#include <ftxui/dom/elements.hpp>
+
+#include "../history/history.hpp"
+
+namespace tui {
+
+// Unicode sparkline of the values, scaled between their minimum and maximum
+std::string sparkline(const std::vector<double>& values);
+
+// Print per-benchmark trends of cost, instruction count and compile time, followed by step regressions
+void showHistory(const std::vector<HistoryRecord>& records);
+
+} // namespace tui
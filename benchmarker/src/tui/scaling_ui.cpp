@@ -0,0 +1,88 @@
+#include "scaling_ui.hpp"
+
+#include <format>
+#include <iostream>
+#include <print>
+#include <ftxui/screen/screen.hpp>
+
+#include "history_ui.hpp"
+
+namespace tui
+{
+
+	namespace
+	{
+		void print(const ftxui::Element& element)
+		{
+			auto screen = ftxui::Screen::Create(ftxui::Dimension::Fit(element));
+			ftxui::Render(screen, element);
+			screen.Print();
+			std::cout << std::endl;
+		}
+
+		std::string exponent(const std::optional<double>& value)
+		{
+			return value ? std::format("~ n^{:.2f}", *value) : "~ n^?";
+		}
+
+		ftxui::Element cell(const std::string& content, int width)
+		{
+			return ftxui::text(content) | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, width);
+		}
+	}
+
+
+	void showScaling(const std::vector<ScalingSeries>& series)
+	{
+		std::println();
+
+		for (const auto& s : series)
+		{
+			std::vector<double> times, instructions;
+			ftxui::Elements rows;
+			rows.push_back(ftxui::hbox({
+				cell("size", 10), cell("compile [ms]", 16), cell("peak RSS [MiB]", 16), cell("instructions", 16),
+			}) | ftxui::color(ftxui::Color::GrayDark));
+
+			for (const auto& point : s.points)
+			{
+				if (!point.success)
+				{
+					rows.push_back(ftxui::hbox({
+						cell(std::to_string(point.size), 10),
+						ftxui::text(" COMPILATION FAILED: " + point.error_message) | ftxui::color(ftxui::Color::Red),
+					}));
+					continue;
+				}
+
+				times.push_back(point.compile_us);
+				instructions.push_back(static_cast<double>(point.instructions));
+				rows.push_back(ftxui::hbox({
+					cell(std::to_string(point.size), 10),
+					cell(std::format("{:.2f}", point.compile_us / 1000), 16),
+					cell(std::format("{:.1f}", point.max_rss_kb / 1024.0), 16),
+					cell(std::to_string(point.instructions), 16),
+				}));
+			}
+
+			rows.push_back(ftxui::hbox({
+				cell("compile", 14), cell(sparkline(times), 20), cell(exponent(s.time_exponent), 12),
+			}));
+			rows.push_back(ftxui::hbox({
+				cell("instructions", 14), cell(sparkline(instructions), 20), cell(exponent(s.instruction_exponent), 12),
+			}));
+
+			print(ftxui::vbox({
+				ftxui::hbox({
+					ftxui::text(s.family) | ftxui::bold | ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 30),
+					s.super_linear
+						? ftxui::text(" SUPER-LINEAR") | ftxui::color(ftxui::Color::Red) | ftxui::bold
+						: ftxui::text(" ok") | ftxui::color(ftxui::Color::Green),
+				}),
+				ftxui::vbox(std::move(rows)),
+				ftxui::separator(),
+			}));
+		}
+	}
+
+} // namespace tui
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <vector>
+#include <ftxui/dom/elements.hpp>
+
+#include "../scaling/scaling.hpp"
+
+namespace tui {
+
+// Print compile time, peak memory and instruction count of every family against size, with the fitted exponents
+void showScaling(const std::vector<ScalingSeries>& series);
+
+} // namespace tui
@@ -0,0 +1,84 @@
+#include <iostream>
+
+#include <filesystem>
+#include <fstream>
+#include <print>
+#include <argparse/argparse.hpp>
+
+#include "../global/colors.hpp"
+#include "../global/vm/program.hpp"
+#include "../global/vm/loader.hpp"
+#include "../global/vm/image.hpp"
+
+
+struct Arguments
+{
+	std::filesystem::path input;
+	std::filesystem::path output;
+	bool lines;
+};
+
+
+Arguments parse_args(const int argc, char const* argv[])
+{
+	argparse::ArgumentParser parser;
+	parser.add_argument<std::string>("file")
+		.help("input .mr file, or an .mrb image to turn back into text")
+		.required();
+	parser.add_argument<std::string>("--output", "-o")
+		.help("output file (default: input file with .mrb, or .mr for an image)");
+	parser.add_argument("--no-lines")
+		.help("do not store the source line of every instruction")
+		.flag();
+
+	try
+	{
+		parser.parse_args(argc, argv);
+	}
+	catch(const std::exception& e)
+	{
+		std::println(std::cerr, "{}", e.what());
+		std::exit(1);
+	}
+
+	std::filesystem::path input = parser.get<std::string>("file");
+	const std::string_view extension = vm::isImageFile(input) ? ".mr" : ".mrb";
+	std::filesystem::path output = parser.is_used("--output") ? parser.get<std::string>("--output") : std::filesystem::path(input).replace_extension(extension);
+
+	return { input, output, !parser.get<bool>("--no-lines") };
+}
+
+
+int main(const int argc, char const * argv[])
+{
+	const auto [input, output, keep_lines] = parse_args(argc, argv);
+	const bool from_image = vm::isImageFile(input);
+
+	std::vector<int> lines;
+	const auto program = vm::loadProgram(input, &lines);
+	if (!program)
+	{
+		std::println(std::cerr, "{}Error: {}{}", cRed, program.error().describe(), cReset);
+		return -1;
+	}
+
+	if (from_image)
+	{
+		std::ofstream file(output);
+		if (!file)
+		{
+			std::println(std::cerr, "{}Error: could not open '{}'{}", cRed, output.string(), cReset);
+			return -1;
+		}
+		for (const vm::Instruction& instruction : program->code)
+			file << vm::disassemble(instruction) << '\n';
+	}
+	else if (const auto saved = vm::saveImage(output, *program, keep_lines ? lines : std::vector<int>{}); !saved)
+	{
+		std::println(std::cerr, "{}Error: {}{}", cRed, saved.error().describe(), cReset);
+		return -1;
+	}
+
+	std::println("{} -> {} ({} instructions)", input.string(), output.string(), program->code.size());
+	return 0;
+}
@@ -21,9 +21,11 @@
 
 #include "../global/colors.hpp"
 #include "../global/instructions.hpp"
+#include "../global/vm/program.hpp"
+#include "../global/vm/loader.hpp"
+#include "../global/vm/image.hpp"
 
-extern void run_parser(std::vector<std::pair<int, var_t>>& program, FILE* data);
-extern void run_machine(std::vector<std::pair<int, var_t>>& program, std::array<var_t, 8>& r, std::map<var_t, var_t>& pam, std::vector<std::string>& instructions, std::span<var_t> cin);
+extern void run_machine(const vm::Program& program, std::vector<std::string>& instructions, std::span<var_t> cin);
 
 
 std::pair<std::filesystem::path, std::string> parse_args(const int argc, char const* argv[])
@@ -54,38 +56,33 @@ std::pair<std::filesystem::path, std::string> parse_args(const int argc, char co
 }
 
 
-void parse(std::vector<std::pair<int, var_t>>& program, const std::string_view filename)
-{
-	FILE* data = fopen(filename.data(), "r");
-	if( !data ) {
-		std::println(std::cerr, "{}Error: could not open '{}'{}", cRed, filename, cReset);
-		std::exit(-1);
-	}
-
-	run_parser(program, data);
-
-	fclose(data);
-}
-
-
-
 int main(const int argc, char const * argv[]) {
-	std::vector<std::pair<int, var_t>> program;
-
 	auto [filename, console_in] = parse_args(argc, argv);
 
+	auto loaded = vm::loadProgram(filename);
+	if (!loaded)
+	{
+		std::println(std::cerr, "{}Error: {}{}", cRed, loaded.error().describe(), cReset);
+		std::exit(-1);
+	}
+	vm::Program decoded = std::move(*loaded);
 	
-	parse(program, filename.string());
-	
-	ke::FileReader instr_file(filename);
-	std::vector<std::string> instructions = instr_file.readAll();
-
-	std::array<var_t, 8> registers;
-	std::map<var_t, var_t> memory;
+	// an image has no source text, so its instructions are shown disassembled
+	std::vector<std::string> instructions;
+	if (vm::isImageFile(filename))
+	{
+		for (const vm::Instruction& instruction : decoded.code)
+			instructions.push_back(vm::disassemble(instruction));
+	}
+	else
+	{
+		ke::FileReader instr_file(filename);
+		instructions = instr_file.readAll();
+	}
 
 	std::vector<var_t> cin = ke::splitString<var_t>(console_in, {" "}, [](const std::string& str){ return ke::fromString<var_t>(str).value_or(0); });
 
-	run_machine(program, registers, memory, instructions, cin);
+	run_machine(decoded, instructions, cin);
 
 	return 0;
 }
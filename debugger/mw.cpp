@@ -20,9 +20,16 @@
 #include <utility>
 #include <vector>
 #include <map>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <charconv>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
-#include <cstdlib> 	// rand()
-#include <ctime>
+#include <span>
 
 // FTXUI
 #include <ftxui/component/component.hpp>
@@ -31,109 +38,267 @@
 
 #include "../global/instructions.hpp"
 #include "../global/colors.hpp"
+#include "../global/vm/program.hpp"
+#include "../global/vm/machine.hpp"
 
 
 
-void run_machine(std::vector<std::pair<int, var_t>>& program, std::array<var_t, 8>& r, std::map<var_t, var_t>& pam, std::vector<std::string>& instructions, std::span<var_t> cin)
+// Input comes from the command line; every READ and WRITE is also logged
+class LogIO
+{
+private:
+
+	std::span<var_t> m_cin;
+	size_t m_next = 0;
+	std::function<void(const std::string&)> m_log;
+
+public:
+
+	using Word = var_t;
+
+	LogIO(std::span<var_t> cin, std::function<void(const std::string&)> log)
+		: m_cin(cin), m_log(std::move(log))
+	{
+	}
+
+	bool read(var_t& value)
+	{
+		if (m_next >= m_cin.size())
+			return false;
+		value = m_cin[m_next++];
+		m_log(std::format("? {}", value));
+		return true;
+	}
+
+	void write(const var_t value)
+	{
+		m_log(std::format("> {}", value));
+	}
+};
+
+using DebugMachine = vm::Machine<vm::NoTrace, vm::PatchedBreakpoints, vm::InstructionCost, LogIO>;
+
+// What the screen shows while the worker thread owns the machine
+struct Snapshot
 {
-	constinit static std::array<std::string, 8> reg_string_mapper = {
-		"RA", "RB", "RC", "RD", "RE", "RF", "RG", "RH"
-	};
-	
-	var_t tmp {};
 	var_t lr = 0;
-	var_t t = 0;
-	var_t io {};
+	var_t cost = 0;
+	std::array<var_t, 8> r {};
+	uint64_t executed = 0;
+	double per_second = 0;
+};
 
-	size_t stdin_counter = 0;
+// screen updates while running are posted at most this often
+constexpr std::chrono::milliseconds snapshot_interval(100);
+// the worker runs the machine in slices, checking for pause in between; a slice grows until it takes this long
+constexpr std::chrono::milliseconds slice_target(5);
 
-	std::srand(std::time(0));
-	for(int i = 0; i<8; i++ ) 
-		r[i] = rand();
+
+void run_machine(const vm::Program& program, std::vector<std::string>& instructions, std::span<var_t> cin)
+{
+	constinit static std::array<std::string, 8> reg_string_mapper = {
+		"RA", "RB", "RC", "RD", "RE", "RF", "RG", "RH"
+	};
 
 	std::vector<std::string> logs;
 	logs.push_back("Debugger started.");
 
+	// READ and WRITE log from the worker thread
+	std::mutex logs_mutex;
 	auto log = [&](const std::string& msg) {
+		std::lock_guard lock(logs_mutex);
 		logs.push_back(msg);
 		if (logs.size() > 50) logs.erase(logs.begin());
 	};
 
-	std::function<void()> step = [&]() {
-		if( lr < 0 || lr >= (int)program.size() ) {
-			log(std::format("ERROR: PC out of bounds: {}", lr));
-			return;
-		}
+	DebugMachine machine(program, LogIO(cin, log));
+	auto& r = machine.r;
+	const var_t& lr = machine.lr;
 
-		if (program[lr].first == HALT) {
-			log("Program HALTED.");
-			return;
+	auto report = [&](const vm::Status status) {
+		switch (status)
+		{
+			case vm::Status::Halted:
+				log("Program HALTED.");
+				break;
+			case vm::Status::InputExhausted:
+				log("READ past the end of stdin, program stopped.");
+				break;
+			case vm::Status::BadJump:
+				log(std::format("ERROR: PC out of bounds: {}", lr));
+				break;
+			case vm::Status::Breakpoint:
+				log(std::format("Breakpoint at {}.", lr));
+				break;
+			default:
+				break;
 		}
+	};
+
+	// commands get the text after the command word; execution between stops runs without rendering
+	using Command = std::function<void(const std::string&)>;
 
-		switch( program[lr].first )
+	auto number = [&](const std::string& arg) -> std::optional<var_t> {
+		var_t value = 0;
+		const auto [end, error] = std::from_chars(arg.data(), arg.data() + arg.size(), value);
+		if (error != std::errc() || end != arg.data() + arg.size() || value < 0)
 		{
-			case READ:
-				if (stdin_counter >= cin.size())
+			log(std::format("expected a number, got '{}'", arg));
+			return std::nullopt;
+		}
+		return value;
+	};
+
+	auto screen = ftxui::ScreenInteractive::Fullscreen();
+	const auto exit_loop = screen.ExitLoopClosure();
+
+	// Long runs happen on a worker thread. While `running` is set, the worker owns the machine and
+	// the screen only reads `snapshot`; every command but pause and quit is refused.
+	std::atomic<bool> running = false;
+	std::mutex snapshot_mutex;
+	Snapshot snapshot;
+	std::jthread worker;
+
+	auto publish = [&](const uint64_t executed, const double seconds) {
+		std::lock_guard lock(snapshot_mutex);
+		snapshot = Snapshot { .lr = lr, .cost = machine.cost(), .r = r, .executed = executed, .per_second = seconds > 0 ? executed / seconds : 0 };
+	};
+
+	// runs up to `steps` instructions, until the cost reaches `until_cost`, or until a stop
+	auto start = [&](const uint64_t steps, const var_t until_cost) {
+		publish(0, 0);
+		running = true;
+		worker = std::jthread([&, steps, until_cost](const std::stop_token stop) {
+			using clock = std::chrono::steady_clock;
+			const auto begin = clock::now();
+			auto last_post = begin;
+			uint64_t executed = 0;
+			uint64_t slice = 1 << 16;
+			vm::Status status = vm::Status::Running;
+
+			while (!stop.stop_requested() && executed < steps && machine.cost() < until_cost)
+			{
+				const uint64_t budget = std::min(slice, steps - executed);
+				const auto slice_begin = clock::now();
+				status = machine.run(budget, until_cost);
+				const auto now = clock::now();
+				executed += machine.executed();
+				if (status != vm::Status::Running)
+					break;
+
+				if (now - slice_begin < slice_target && slice < (uint64_t(1) << 32))
+					slice *= 2;
+				if (now - last_post >= snapshot_interval)
 				{
-					log("stdin out of range, setting input to 0");
-					r[0] = 0; // consistent mock
-					io+=100; lr++; break;
+					publish(executed, std::chrono::duration<double>(now - begin).count());
+					screen.PostEvent(ftxui::Event::Custom);
+					last_post = now;
 				}
+			}
+
+			const double seconds = std::chrono::duration<double>(clock::now() - begin).count();
+			report(status);
+			if (status == vm::Status::Running)
+			{
+				if (stop.stop_requested())
+					log(std::format("Paused at {}.", lr));
+				else if (machine.cost() >= until_cost)
+					log(std::format("Cost {} reached at {}.", machine.cost(), lr));
 				else
-				{
-					log(std::format("? {}", cin[stdin_counter]));
-					r[0] = cin[stdin_counter]; stdin_counter++;
-					io += 100; lr++; break;
-				}
-			case WRITE:		
-				log(std::format("> {}", r[0])); 
-				io+=100; lr++; break;
-
-			case LOAD:		r[0] = pam[program[lr].second]; t+=50; lr++; break;
-			case STORE:		pam[program[lr].second] = r[0]; t+=50; lr++; break;
-			case RLOAD:		r[0] = pam[r[program[lr].second]]; t+=50; lr++; break;
-			case RSTORE:	pam[r[program[lr].second]] = r[0]; t+=50; lr++; break;
-
-			case ADD:		r[0] += r[program[lr].second]; t+=5; lr++; break;
-			case SUB:		r[0] -= r[0]>=r[program[lr].second]?r[program[lr].second]:r[0]; t+=5; lr++; break;
-			case SWP:		tmp = r[program[lr].second]; r[program[lr].second] = r[0]; r[0] = tmp; t+=5; lr++; break;
-
-			case RST:		r[program[lr].second] = 0; t+=1; lr++; break;
-			case INC:		r[program[lr].second]++; t+=1; lr++; break;
-			case DEC:		if(r[program[lr].second]>0) r[program[lr].second]--; t+=1; lr++; break;
-			case SHL:		r[program[lr].second]<<=1; t+=1; lr++; break;
-			case SHR:		r[program[lr].second]>>=1; t+=1; lr++; break;
-
-			case JUMP: 		lr = program[lr].second; t+=1; break;
-			case JPOS:		if(r[0] > 0)  lr = program[lr].second; else lr++; t+=1; break;
-			case JZERO:		if(r[0] == 0) lr = program[lr].second; else lr++; t+=1; break;
-			
-			case CALL:		r[0] = lr+1; lr = program[lr].second; t+=1; break;
-			case RTRN:		lr = r[0]; t+=1; break;
-
-			default: break;
+					log(std::format("Stopped after {} instructions at {}.", executed, lr));
+			}
+			if (seconds >= snapshot_interval.count() / 1000.0)
+				log(std::format("about {} instructions in {:.2f} s ({:.1f}M/s)", executed, seconds, executed / seconds / 1e6));
+
+			publish(executed, seconds);
+			running = false;
+			screen.PostEvent(ftxui::Event::Custom);
+		});
+	};
+
+	auto pause = [&]() {
+		if (running)
+			worker.request_stop();
+	};
+
+	Command step = [&](const std::string& arg) {
+		if (arg.empty())
+			return report(machine.step());
+		if (const auto count = number(arg))
+			start(static_cast<uint64_t>(*count), std::numeric_limits<var_t>::max());
+	};
+
+	Command resume = [&](const std::string&) {
+		start(std::numeric_limits<uint64_t>::max(), std::numeric_limits<var_t>::max());
+	};
+
+	Command until = [&](const std::string& arg) {
+		if (const auto cost = number(arg))
+			start(std::numeric_limits<uint64_t>::max(), *cost);
+	};
+
+	Command set_breakpoint = [&](const std::string& arg) {
+		const auto pc = arg.empty() ? std::optional<var_t>(lr) : number(arg);
+		if (!pc)
+			return;
+		if (*pc >= static_cast<var_t>(program.code.size()))
+			return log(std::format("no instruction {}", *pc));
+		machine.setBreakpoint(*pc);
+		log(std::format("Breakpoint set at {}.", *pc));
+	};
+
+	Command clear_breakpoint = [&](const std::string& arg) {
+		if (const auto pc = arg.empty() ? std::optional<var_t>(lr) : number(arg))
+		{
+			machine.clearBreakpoint(*pc);
+			log(std::format("Breakpoint at {} deleted.", *pc));
 		}
 	};
 
-	auto screen = ftxui::ScreenInteractive::Fullscreen();
-	const std::map<std::string, std::function<void()>> command_mapper = {
+	const Command quit = [&](const std::string&) {
+		pause();
+		exit_loop();
+	};
+	const Command pause_command = [&](const std::string&) { pause(); };
+
+	const std::map<std::string, Command> command_mapper = {
 		{ "n", step },
 		{ "next", step },
+		{ "s", step },
+		{ "step", step },
 		{ "", step },
-		{ "q", screen.ExitLoopClosure() },
-		{ "quit", screen.ExitLoopClosure() },
+		{ "c", resume },
+		{ "continue", resume },
+		{ "u", until },
+		{ "until", until },
+		{ "b", set_breakpoint },
+		{ "break", set_breakpoint },
+		{ "d", clear_breakpoint },
+		{ "delete", clear_breakpoint },
+		{ "p", pause_command },
+		{ "pause", pause_command },
+		{ "q", quit },
+		{ "quit", quit },
 	};
 
 	std::string input_buffer;
 
 	// View Components
+	auto shown_lr = [&]() {
+		std::lock_guard lock(snapshot_mutex);
+		return running ? snapshot.lr : lr;
+	};
+
 	auto code_renderer = ftxui::Renderer([&] {
 		ftxui::Elements lines;
+		const var_t lr = shown_lr();
 		int start = std::max(0, (int)lr - 15);
 		int end = std::min((int)instructions.size(), start + 30);
 		
 		for(int i = start; i < end; ++i) {
-			auto content = ftxui::text(std::format("{:04} {}", i, instructions[i]));
+			auto content = ftxui::text(std::format("{}{:04} {}", machine.hasBreakpoint(i) ? "*" : " ", i, instructions[i]));
+			if (machine.hasBreakpoint(i))
+				content = content | ftxui::color(ftxui::Color::Red);
 			if (i == lr) {
 				lines.push_back(content | ftxui::bold | ftxui::bgcolor(ftxui::Color::Blue));
 			} else {
@@ -145,25 +310,29 @@ void run_machine(std::vector<std::pair<int, var_t>>& program, std::array<var_t,
 
 	auto regs_renderer = ftxui::Renderer([&] {
 		ftxui::Elements items;
+		std::lock_guard lock(snapshot_mutex);
+		const auto& shown = running ? snapshot.r : r;
 		for(int i=0; i<8; ++i) {
-			items.push_back(ftxui::text(std::format("{} = {}", reg_string_mapper[i], r[i])));
+			items.push_back(ftxui::text(std::format("{} = {}", reg_string_mapper[i], shown[i])));
 		}
 		return ftxui::window(ftxui::text("Registers"), ftxui::vbox(std::move(items)));
 	});
 
 	auto mem_renderer = ftxui::Renderer([&] {
 		ftxui::Elements items;
-		int count = 0;
-		if (pam.empty()) items.push_back(ftxui::text("Empty"));
-		for(const auto& [addr, val] : pam) {
+		if (running)
+			return ftxui::window(ftxui::text("Memory"), ftxui::text("running..."));
+		const auto cells = machine.memory.snapshot(21);
+		if (cells.empty()) items.push_back(ftxui::text("Empty"));
+		for(const auto& [addr, val] : cells) {
 			items.push_back(ftxui::text(std::format("[{}] = {}", addr, val)));
-			if (++count > 20) break;
 		}
 		return ftxui::window(ftxui::text("Memory"), ftxui::vbox(std::move(items)));
 	});
 
 	auto log_renderer = ftxui::Renderer([&] {
 		ftxui::Elements items;
+		std::lock_guard lock(logs_mutex);
 		int start = std::max(0, (int)logs.size() - 8);
 		for(size_t i = start; i < logs.size(); ++i) {
 			items.push_back(ftxui::text(logs[i]));
@@ -175,12 +344,18 @@ void run_machine(std::vector<std::pair<int, var_t>>& program, std::array<var_t,
 	ftxui::InputOption input_opt;
 	input_opt.multiline = false;
 	input_opt.on_enter = [&] {
-		auto command_ptr = command_mapper.find(input_buffer);
+		std::istringstream words(input_buffer);
+		std::string name, arg;
+		words >> name >> arg;
+
+		auto command_ptr = command_mapper.find(name);
 		if (command_ptr == command_mapper.end())
 			log(std::format("unknown command: '{}'", input_buffer));
+		else if (running && name != "p" && name != "pause" && name != "q" && name != "quit")
+			log("the program is running, 'pause' it first");
 		else {
 			auto callback = command_ptr->second;
-			callback();
+			callback(arg);
 		}
 
 		input_buffer.clear();
@@ -200,6 +375,14 @@ void run_machine(std::vector<std::pair<int, var_t>>& program, std::array<var_t,
 		}) | ftxui::flex,
 	});
 
+	auto status_bar = [&]() {
+		if (!running)
+			return ftxui::text(std::format("Cycle: {} IO: {}", machine.t, machine.io));
+		std::lock_guard lock(snapshot_mutex);
+		return ftxui::text(std::format("RUNNING pc: {} cost: {} ({:.1f}M instr/s)", snapshot.lr, snapshot.cost, snapshot.per_second / 1e6))
+			| ftxui::color(ftxui::Color::Yellow);
+	};
+
 	auto main_renderer = ftxui::Renderer(layout, [&] {
 		return ftxui::vbox({
 			ftxui::hbox({
@@ -212,14 +395,32 @@ void run_machine(std::vector<std::pair<int, var_t>>& program, std::array<var_t,
 			}) | ftxui::flex,
 			ftxui::separator(),
 			ftxui::hbox({
-				ftxui::text(std::format("Cycle: {} IO: {}", t, io)) | ftxui::border,
+				status_bar() | ftxui::border,
 				input_component->Render() | ftxui::color(ftxui::Color::White) | ftxui::bgcolor(ftxui::Color::Black) | ftxui::flex
 			})
 		});
 	});
 
-	screen.Loop(main_renderer);
+	// Ctrl-C pauses a run instead of leaving the debugger; when nothing runs it quits as before
+	screen.ForceHandleCtrlC(false);
+	auto app = ftxui::CatchEvent(main_renderer, [&](const ftxui::Event& event) {
+		if (!(event == ftxui::Event::CtrlC))
+			return false;
+		if (running)
+			pause();
+		else
+			exit_loop();
+		return true;
+	});
+
+	screen.Loop(app);
+
+	if (worker.joinable())
+	{
+		worker.request_stop();
+		worker.join();
+	}
 
-	std::println("{2}Program finished (cost: {3}{0}{2}; incl. i/o: {1}).{4}", t + io, io, cBlue, cRed, cReset);
+	std::println("{2}Program finished (cost: {3}{0}{2}; incl. i/o: {1}).{4}", machine.cost(), machine.io, cBlue, cRed, cReset);
 }
 
@@ -0,0 +1,185 @@
+#include "generator.hpp"
+
+#include <format>
+#include <random>
+
+
+namespace gen
+{
+
+	namespace
+	{
+		std::string indent(const size_t depth)
+		{
+			return std::string(2 * depth + 2, ' ');
+		}
+
+		std::string header(const Family family, const size_t size, const uint32_t seed)
+		{
+			return std::format("# generated: {} {} (seed {})\n\n", familyName(family), size, seed);
+		}
+
+
+		// pa(x, y): y := x + 1; every later procedure calls its predecessor and adds its own constant
+		std::string procedures(const size_t count)
+		{
+			std::string code;
+			for (size_t k = 0; k < count; k++)
+			{
+				const std::string name = identifier("p", k);
+				if (k == 0)
+				{
+					code += std::format("PROCEDURE {}(I x, O y) IS\nIN\n  y := x + 1;\nEND\n\n", name);
+					continue;
+				}
+				code += std::format(
+					"PROCEDURE {}(I x, O y) IS\n  t\nIN\n  {}(x, t);\n  y := t + {};\nEND\n\n",
+					name, identifier("p", k - 1), k + 1
+				);
+			}
+
+			code += "PROGRAM IS\n  a, b, r\nIN\n  READ a;\n  READ b;\n";
+			if (count > 0)
+				code += std::format("  {}(a, r);\n", identifier("p", count - 1));
+			else
+				code += "  r := a;\n";
+			code += "  r := r + b;\n  WRITE r;\nEND\n";
+			return code;
+		}
+
+		// levels cycle through IF, FOR and WHILE; every loop runs once, so the program runs in O(D)
+		std::string nesting(const size_t depth)
+		{
+			std::string declarations = "a, b";
+			for (size_t k = 0; k < depth; k++)
+			{
+				if (k % 3 == 2)
+					declarations += ", " + identifier("c", k);
+			}
+
+			std::string open, close;
+			for (size_t k = 0; k < depth; k++)
+			{
+				const std::string pad = indent(k);
+				switch (k % 3)
+				{
+				case 0:
+					open += std::format("{}IF a >= {} THEN\n", pad, k);
+					close = std::format("{}ELSE\n{}  b := b + {};\n{}ENDIF\n", pad, pad, k, pad) + close;
+					break;
+				case 1:
+					open += std::format("{}FOR {} FROM 1 TO 1 DO\n", pad, identifier("i", k));
+					close = std::format("{}ENDFOR\n", pad) + close;
+					break;
+				case 2:
+				{
+					const std::string counter = identifier("c", k);
+					open += std::format("{}{} := 0;\n{}WHILE {} < 1 DO\n{}  {} := {} + 1;\n", pad, counter, pad, counter, pad, counter, counter);
+					close = std::format("{}ENDWHILE\n", pad) + close;
+					break;
+				}
+				}
+			}
+
+			return std::format(
+				"PROGRAM IS\n  {}\nIN\n  READ a;\n  READ b;\n{}{}  a := a + b;\n{}  WRITE a;\nEND\n",
+				declarations, open, indent(depth), close
+			);
+		}
+
+		std::string arrays(const size_t length)
+		{
+			const size_t last = length > 0 ? length - 1 : 0;
+			return std::format(
+				"PROCEDURE fill(T t, I n, I v) IS\nIN\n"
+				"  FOR i FROM 0 TO n DO\n    t[i] := i + v;\n  ENDFOR\nEND\n\n"
+				"PROCEDURE sum(T t, I n, O s) IS\nIN\n"
+				"  s := 0;\n  FOR i FROM 0 TO n DO\n    s := s + t[i];\n  ENDFOR\nEND\n\n"
+				"PROGRAM IS\n  a, b, n, s, r, t[0:{0}], u[1:{1}]\nIN\n  READ a;\n  READ b;\n"
+				"  n := {0};\n  fill(t, n, a);\n"
+				"  FOR j FROM 1 TO {1} DO\n    u[j] := j * b;\n  ENDFOR\n"
+				"  sum(t, n, s);\n  r := s + u[{1}];\n  r := r + t[{0}];\n  WRITE r;\nEND\n",
+				last, last + 1
+			);
+		}
+
+		// v_k := v_(k-1) op operand, where the operand is an input, a constant or an earlier temporary
+		std::string expressions(const size_t size, std::mt19937& rng)
+		{
+			constexpr std::array<std::string_view, 5> operators = { "+", "-", "*", "/", "%" };
+
+			std::string declarations = "a, b";
+			for (size_t k = 0; k <= size; k++)
+				declarations += ", " + identifier("v", k);
+
+			std::string body = std::format("  {} := a + b;\n", identifier("v", 0));
+			for (size_t k = 1; k <= size; k++)
+			{
+				std::string operand;
+				switch (rng() % 4)
+				{
+				case 0: operand = "a"; break;
+				case 1: operand = "b"; break;
+				case 2: operand = std::to_string(1 + rng() % 1000); break;
+				default: operand = identifier("v", k / 2); break;
+				}
+				body += std::format("  {} := {} {} {};\n", identifier("v", k), identifier("v", k - 1), operators[rng() % operators.size()], operand);
+			}
+
+			return std::format(
+				"PROGRAM IS\n  {}\nIN\n  READ a;\n  READ b;\n{}  WRITE {};\nEND\n",
+				declarations, body, identifier("v", size)
+			);
+		}
+	}
+
+
+	std::string identifier(const std::string_view prefix, size_t index)
+	{
+		std::string suffix;
+		do
+		{
+			suffix.insert(suffix.begin(), static_cast<char>('a' + index % 26));
+			index /= 26;
+		} while (index != 0);
+		return std::format("{}_{}", prefix, suffix);
+	}
+
+	std::string_view familyName(const Family family)
+	{
+		switch (family)
+		{
+		case Family::Procedures:	return "procedures";
+		case Family::Nesting:		return "nesting";
+		case Family::Arrays:		return "arrays";
+		case Family::Expressions:	return "expressions";
+		}
+		return "";
+	}
+
+	std::optional<Family> familyFromString(const std::string_view name)
+	{
+		for (const Family family : families)
+		{
+			if (familyName(family) == name)
+				return family;
+		}
+		return std::nullopt;
+	}
+
+	std::string generateProgram(const Family family, const size_t size, const uint32_t seed)
+	{
+		std::mt19937 rng(seed);
+
+		std::string body;
+		switch (family)
+		{
+		case Family::Procedures:	body = procedures(size); break;
+		case Family::Nesting:		body = nesting(size); break;
+		case Family::Arrays:		body = arrays(size); break;
+		case Family::Expressions:	body = expressions(size, rng); break;
+		}
+		return header(family, size, seed) + body;
+	}
+
+} // namespace gen
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+
+namespace gen
+{
+
+// Program families; the size parameter grows one dimension of the program and keeps the rest fixed.
+enum class Family
+{
+	Procedures,		// N procedures, each calling the previous one
+	Nesting,		// IF/FOR/WHILE nested D deep
+	Arrays,			// arrays of length L, filled and read through a procedure
+	Expressions,	// one expression of S binary operations, split into temporaries
+};
+
+constexpr std::array<Family, 4> families = { Family::Procedures, Family::Nesting, Family::Arrays, Family::Expressions };
+
+// identifiers may only contain [_a-z], so the index is spelled in base 26: prefix_a, prefix_b, ..., prefix_ba, ...
+std::string identifier(std::string_view prefix, size_t index);
+
+std::string_view familyName(Family family);
+std::optional<Family> familyFromString(std::string_view name);
+
+/**
+ * @brief Generates a valid, terminating .imp program of the given family and size.
+ *
+ * @details
+ * The program reads two numbers and writes one, so it can also be run on the VM.
+ * The same family, size and seed always give the same program.
+ */
+std::string generateProgram(Family family, size_t size, uint32_t seed = 1);
+
+} // namespace gen
@@ -0,0 +1,150 @@
+#include "imp.hpp"
+
+#include <format>
+
+
+namespace gen
+{
+
+	namespace
+	{
+		std::string value(const Value& v)
+		{
+			switch (v.kind)
+			{
+			case Value::Kind::Number:	return std::to_string(v.number);
+			case Value::Kind::Variable:	return v.name;
+			case Value::Kind::Element:	return std::format("{}[{}]", v.name, v.index.empty() ? std::to_string(v.index_number) : v.index);
+			}
+			return "";
+		}
+
+		std::string expression(const Expression& e)
+		{
+			if (e.op == 0)
+				return value(e.left);
+			return std::format("{} {} {}", value(e.left), e.op, value(e.right));
+		}
+
+		std::string condition(const Condition& c)
+		{
+			return std::format("{} {} {}", value(c.left), c.op, value(c.right));
+		}
+
+		std::string declarations(const std::vector<Declaration>& list)
+		{
+			std::string line;
+			for (const auto& declaration : list)
+			{
+				if (!line.empty())
+					line += ", ";
+				line += declaration.array ? std::format("{}[{}:{}]", declaration.name, declaration.low, declaration.high) : declaration.name;
+			}
+			return line;
+		}
+
+		void block(std::string& out, const Block& commands, const size_t depth)
+		{
+			const std::string pad(2 * depth, ' ');
+			for (const auto& command : commands)
+			{
+				switch (command.kind)
+				{
+				case Command::Kind::Assign:
+					out += std::format("{}{} := {};\n", pad, value(command.target), expression(command.expression));
+					break;
+				case Command::Kind::If:
+					out += std::format("{}IF {} THEN\n", pad, condition(command.condition));
+					block(out, command.body, depth + 1);
+					if (!command.otherwise.empty())
+					{
+						out += pad + "ELSE\n";
+						block(out, command.otherwise, depth + 1);
+					}
+					out += pad + "ENDIF\n";
+					break;
+				case Command::Kind::While:
+					out += std::format("{}WHILE {} DO\n", pad, condition(command.condition));
+					block(out, command.body, depth + 1);
+					out += pad + "ENDWHILE\n";
+					break;
+				case Command::Kind::Repeat:
+					out += pad + "REPEAT\n";
+					block(out, command.body, depth + 1);
+					out += std::format("{}UNTIL {};\n", pad, condition(command.condition));
+					break;
+				case Command::Kind::For:
+					out += std::format("{}FOR {} FROM {} {} {} DO\n", pad, command.iterator, value(command.from), command.downto ? "DOWNTO" : "TO", value(command.to));
+					block(out, command.body, depth + 1);
+					out += pad + "ENDFOR\n";
+					break;
+				case Command::Kind::Read:
+					out += std::format("{}READ {};\n", pad, value(command.target));
+					break;
+				case Command::Kind::Write:
+					out += std::format("{}WRITE {};\n", pad, value(command.value));
+					break;
+				case Command::Kind::Call:
+				{
+					std::string arguments;
+					for (const auto& argument : command.arguments)
+						arguments += (arguments.empty() ? "" : ", ") + argument;
+					out += std::format("{}{}({});\n", pad, command.procedure, arguments);
+					break;
+				}
+				}
+			}
+		}
+
+		size_t count(const Block& commands)
+		{
+			size_t n = 0;
+			for (const auto& command : commands)
+				n += 1 + count(command.body) + count(command.otherwise);
+			return n;
+		}
+	}
+
+
+	std::string print(const Program& program, const std::vector<std::string>& comments)
+	{
+		std::string out;
+		for (const auto& comment : comments)
+			out += std::format("# {}\n", comment);
+		if (!comments.empty())
+			out += "\n";
+
+		for (const auto& procedure : program.procedures)
+		{
+			std::string parameters;
+			for (const auto& parameter : procedure.parameters)
+			{
+				static const char* const prefixes[] = { "", "T ", "I ", "O " };
+				parameters += std::format("{}{}{}", parameters.empty() ? "" : ", ", prefixes[static_cast<int>(parameter.type)], parameter.name);
+			}
+			out += std::format("PROCEDURE {}({}) IS\n", procedure.name, parameters);
+			if (!procedure.locals.empty())
+				out += std::format("  {}\n", declarations(procedure.locals));
+			out += "IN\n";
+			block(out, procedure.body, 1);
+			out += "END\n\n";
+		}
+
+		out += "PROGRAM IS\n";
+		if (!program.declarations.empty())
+			out += std::format("  {}\n", declarations(program.declarations));
+		out += "IN\n";
+		block(out, program.body, 1);
+		out += "END\n";
+		return out;
+	}
+
+	size_t commandCount(const Program& program)
+	{
+		size_t n = count(program.body);
+		for (const auto& procedure : program.procedures)
+			n += count(procedure.body);
+		return n;
+	}
+
+} // namespace gen
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace gen
+{
+
+// syntax tree of a .imp program, only as detailed as the generator, interpreter and reducer need
+
+struct Value
+{
+	enum class Kind
+	{
+		Number,
+		Variable,
+		Element,	// name[index] or name[index_number]
+	};
+
+	Kind kind = Kind::Number;
+	uint64_t number = 0;
+	std::string name {};
+	std::string index {};		// index variable of an element, empty for a constant index
+	uint64_t index_number = 0;
+};
+
+struct Expression
+{
+	Value left {};
+	char op = 0;		// '+', '-', '*', '/', '%', or 0 for just `left`
+	Value right {};
+};
+
+struct Condition
+{
+	Value left {};
+	std::string op {};	// =, !=, >, <, >=, <=
+	Value right {};
+};
+
+struct Command;
+using Block = std::vector<Command>;
+
+struct Command
+{
+	enum class Kind
+	{
+		Assign,
+		If,
+		While,
+		Repeat,
+		For,
+		Read,
+		Write,
+		Call,
+	};
+
+	Kind kind {};
+	Value target {};				// Assign, Read
+	Expression expression {};		// Assign
+	Value value {};					// Write
+	Condition condition {};			// If, While, Repeat (UNTIL)
+	Block body {};					// If, While, Repeat, For
+	Block otherwise {};				// ELSE of If
+	std::string iterator {};		// For
+	Value from {}, to {};			// For
+	bool downto = false;			// For
+	std::string procedure {};		// Call
+	std::vector<std::string> arguments {};	// Call
+};
+
+struct Declaration
+{
+	std::string name {};
+	bool array = false;
+	uint64_t low = 0;		// array range [low:high]
+	uint64_t high = 0;
+};
+
+struct Parameter
+{
+	enum class Type
+	{
+		Plain,		// read and written by reference
+		Array,		// T
+		Input,		// I, read-only
+		Output,		// O, undefined on entry
+	};
+
+	Type type {};
+	std::string name {};
+};
+
+struct Procedure
+{
+	std::string name {};
+	std::vector<Parameter> parameters {};
+	std::vector<Declaration> locals {};
+	Block body {};
+};
+
+struct Program
+{
+	std::vector<Procedure> procedures {};
+	std::vector<Declaration> declarations {};
+	Block body {};
+};
+
+// source text, preceded by one `# ` line per comment
+std::string print(const Program& program, const std::vector<std::string>& comments = {});
+
+// number of commands, including nested ones
+size_t commandCount(const Program& program);
+
+} // namespace gen
@@ -0,0 +1,302 @@
+#include "interpret.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <map>
+#include <string>
+
+
+namespace gen
+{
+
+	namespace
+	{
+		constexpr uint64_t max_value = uint64_t(1) << 63;
+
+		// thrown for anything that makes the program invalid
+		struct Undefined {};
+
+		struct Binding
+		{
+			bool array = false;
+			bool readonly = false;
+			size_t cell = 0;		// first cell of an array
+			uint64_t low = 0;
+			uint64_t high = 0;
+		};
+
+		using Frame = std::map<std::string, Binding>;
+
+		class Interpreter
+		{
+		public:
+
+			Interpreter(const Program& program, const std::vector<uint64_t>& input, const uint64_t max_operations)
+				: m_program(program), m_input(input), m_max_operations(max_operations)
+			{
+			}
+
+			Execution run()
+			{
+				Frame frame;
+				declare(frame, m_program.declarations);
+				block(frame, m_program.body, m_program.procedures.size());
+				return Execution { .output = std::move(m_output), .operations = m_operations };
+			}
+
+		private:
+
+			void tick(const uint64_t weight = 1)
+			{
+				m_operations += weight;
+				if (m_operations > m_max_operations)
+					throw Undefined {};
+			}
+
+			void declare(Frame& frame, const std::vector<Declaration>& declarations)
+			{
+				for (const auto& declaration : declarations)
+				{
+					if (frame.contains(declaration.name) || (declaration.array && declaration.low > declaration.high))
+						throw Undefined {};
+					Binding binding { .array = declaration.array, .cell = m_cells.size(), .low = declaration.low, .high = declaration.high };
+					m_cells.resize(m_cells.size() + (declaration.array ? declaration.high - declaration.low + 1 : 1));
+					frame.emplace(declaration.name, binding);
+				}
+			}
+
+			static const Binding& lookup(const Frame& frame, const std::string& name)
+			{
+				const auto it = frame.find(name);
+				if (it == frame.end())
+					throw Undefined {};
+				return it->second;
+			}
+
+			size_t cell(const Frame& frame, const Value& value)
+			{
+				switch (value.kind)
+				{
+				case Value::Kind::Number:
+					throw Undefined {};
+				case Value::Kind::Variable:
+				{
+					const Binding& binding = lookup(frame, value.name);
+					if (binding.array)
+						throw Undefined {};
+					return binding.cell;
+				}
+				case Value::Kind::Element:
+				{
+					const Binding& binding = lookup(frame, value.name);
+					if (!binding.array)
+						throw Undefined {};
+					const uint64_t index = value.index.empty() ? value.index_number : read(frame, Value { .kind = Value::Kind::Variable, .name = value.index });
+					if (index < binding.low || index > binding.high)
+						throw Undefined {};
+					return binding.cell + (index - binding.low);
+				}
+				}
+				throw Undefined {};
+			}
+
+			uint64_t read(const Frame& frame, const Value& value)
+			{
+				if (value.kind == Value::Kind::Number)
+					return check(value.number);
+				const auto& content = m_cells[cell(frame, value)];
+				if (!content)
+					throw Undefined {};
+				return *content;
+			}
+
+			void write(const Frame& frame, const Value& target, const uint64_t value)
+			{
+				if (lookup(frame, target.name).readonly)
+					throw Undefined {};
+				m_cells[cell(frame, target)] = check(value);
+			}
+
+			static uint64_t check(const uint64_t value)
+			{
+				if (value >= max_value)
+					throw Undefined {};
+				return value;
+			}
+
+			uint64_t evaluate(const Frame& frame, const Expression& e)
+			{
+				const uint64_t a = read(frame, e.left);
+				if (e.op == 0)
+					return a;
+				const uint64_t b = read(frame, e.right);
+				switch (e.op)
+				{
+				case '+':
+					return check(a + b);
+				case '-':
+					return a > b ? a - b : 0;
+				case '*':
+					tick(std::bit_width(std::min(a, b)));
+					if (a != 0 && b > (max_value - 1) / a)
+						throw Undefined {};
+					return a * b;
+				case '/':
+					tick(std::bit_width(a));
+					return b == 0 ? 0 : a / b;
+				case '%':
+					tick(std::bit_width(a));
+					return b == 0 ? 0 : a % b;
+				}
+				throw Undefined {};
+			}
+
+			bool test(const Frame& frame, const Condition& c)
+			{
+				tick();
+				const uint64_t a = read(frame, c.left);
+				const uint64_t b = read(frame, c.right);
+				if (c.op == "=") return a == b;
+				if (c.op == "!=") return a != b;
+				if (c.op == ">") return a > b;
+				if (c.op == "<") return a < b;
+				if (c.op == ">=") return a >= b;
+				if (c.op == "<=") return a <= b;
+				throw Undefined {};
+			}
+
+			// `visible` procedures may be called: the earlier ones, or all of them from the main program
+			void block(Frame& frame, const Block& commands, const size_t visible)
+			{
+				if (commands.empty())
+					throw Undefined {};
+				for (const auto& command : commands)
+					execute(frame, command, visible);
+			}
+
+			void execute(Frame& frame, const Command& command, const size_t visible)
+			{
+				tick();
+				switch (command.kind)
+				{
+				case Command::Kind::Assign:
+					write(frame, command.target, evaluate(frame, command.expression));
+					break;
+				case Command::Kind::If:
+					if (test(frame, command.condition))
+						block(frame, command.body, visible);
+					else if (!command.otherwise.empty())
+						block(frame, command.otherwise, visible);
+					break;
+				case Command::Kind::While:
+					while (test(frame, command.condition))
+						block(frame, command.body, visible);
+					break;
+				case Command::Kind::Repeat:
+					do
+						block(frame, command.body, visible);
+					while (!test(frame, command.condition));
+					break;
+				case Command::Kind::For:
+					loop(frame, command, visible);
+					break;
+				case Command::Kind::Read:
+					if (m_next_input == m_input.size())
+						throw Undefined {};
+					write(frame, command.target, m_input[m_next_input++]);
+					break;
+				case Command::Kind::Write:
+					m_output.push_back(read(frame, command.value));
+					break;
+				case Command::Kind::Call:
+					call(frame, command, visible);
+					break;
+				}
+			}
+
+			void loop(Frame& frame, const Command& command, const size_t visible)
+			{
+				if (frame.contains(command.iterator))
+					throw Undefined {};
+				// the bounds are evaluated once, before the first iteration
+				const uint64_t from = read(frame, command.from);
+				const uint64_t to = read(frame, command.to);
+
+				const size_t iterator = m_cells.size();
+				m_cells.emplace_back();
+				frame.emplace(command.iterator, Binding { .readonly = true, .cell = iterator });
+
+				if (command.downto ? from >= to : from <= to)
+				{
+					for (uint64_t i = from; ; command.downto ? i-- : i++)
+					{
+						m_cells[iterator] = i;
+						block(frame, command.body, visible);
+						tick();
+						if (i == to)
+							break;
+					}
+				}
+				frame.erase(command.iterator);
+			}
+
+			void call(const Frame& frame, const Command& command, const size_t visible)
+			{
+				size_t index = 0;
+				while (index < visible && m_program.procedures[index].name != command.procedure)
+					index++;
+				if (index == visible)
+					throw Undefined {};
+				const Procedure& procedure = m_program.procedures[index];
+				if (procedure.parameters.size() != command.arguments.size())
+					throw Undefined {};
+				// distinct names are distinct variables, so no two parameters alias
+				for (size_t k = 0; k < command.arguments.size(); k++)
+				{
+					if (std::find(command.arguments.begin() + k + 1, command.arguments.end(), command.arguments[k]) != command.arguments.end())
+						throw Undefined {};
+				}
+
+				Frame callee;
+				for (size_t k = 0; k < command.arguments.size(); k++)
+				{
+					const Parameter& parameter = procedure.parameters[k];
+					Binding binding = lookup(frame, command.arguments[k]);
+					if (binding.array != (parameter.type == Parameter::Type::Array) || callee.contains(parameter.name))
+						throw Undefined {};
+					// read-only values can only be passed on as read-only
+					if (binding.readonly && parameter.type != Parameter::Type::Input)
+						throw Undefined {};
+					if (parameter.type == Parameter::Type::Input)
+						binding.readonly = true;
+					if (parameter.type == Parameter::Type::Output)
+						m_cells[binding.cell].reset();
+					callee.emplace(parameter.name, binding);
+				}
+				declare(callee, procedure.locals);
+				block(callee, procedure.body, index);
+			}
+
+			const Program& m_program;
+			const std::vector<uint64_t>& m_input;
+			const uint64_t m_max_operations;
+
+			std::vector<std::optional<uint64_t>> m_cells;
+			std::vector<uint64_t> m_output;
+			size_t m_next_input = 0;
+			uint64_t m_operations = 0;
+		};
+	}
+
+
+	std::optional<Execution> interpret(const Program& program, const std::vector<uint64_t>& input, const uint64_t max_operations)
+	{
+		try {
+			return Interpreter(program, input, max_operations).run();
+		}
+		catch (const Undefined&) {
+			return std::nullopt;
+		}
+	}
+
+} // namespace gen
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "imp.hpp"
+
+
+namespace gen
+{
+
+struct Execution
+{
+	std::vector<uint64_t> output;
+	uint64_t operations;	// executed commands and conditions; *, / and % count once per bit of their operands
+};
+
+/**
+ * @brief Runs a program by the JFTT2025 semantics: natural numbers, `a - b` clamped at 0,
+ * division and modulo by 0 give 0, parameters are passed by reference.
+ *
+ * @details
+ * This is the reference the compiled program is checked against, so anything the specification
+ * leaves open makes the program invalid instead of guessing: reading an undefined variable, an
+ * index outside the array, a value of 2^63 or more, assigning to an iterator or an I parameter,
+ * calling a procedure that is not defined above, running out of input, an empty block,
+ * or more than `max_operations` operations.
+ *
+ * @return the output and operation count, or nothing for an invalid program
+ */
+std::optional<Execution> interpret(const Program& program, const std::vector<uint64_t>& input, uint64_t max_operations = 1'000'000);
+
+} // namespace gen
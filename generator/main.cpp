@@ -0,0 +1,101 @@
+#include <iostream>
+
+#include <filesystem>
+#include <fstream>
+#include <format>
+#include <print>
+#include <argparse/argparse.hpp>
+
+#include "../global/colors.hpp"
+
+#include "generator.hpp"
+#include "random.hpp"
+#include "interpret.hpp"
+
+
+struct Arguments
+{
+	std::optional<gen::Family> family;	// nothing: a random program
+	size_t size;
+	uint32_t seed;
+	std::filesystem::path output;	// empty: stdout
+};
+
+Arguments parse_args(const int argc, char const* argv[])
+{
+	argparse::ArgumentParser parser;
+	parser.add_argument<std::string>("family")
+		.help("program family: procedures, nesting, arrays, expressions, or random (a fuzzer program with its input)")
+		.choices("procedures", "nesting", "arrays", "expressions", "random")
+		.required();
+	parser.add_argument("size")
+		.help("number of procedures, nesting depth, array length, number of operations or commands")
+		.scan<'i', int>()
+		.required();
+	parser.add_argument("--seed")
+		.help("seed of the random choices (expressions and random only)")
+		.default_value(1)
+		.scan<'i', int>();
+	parser.add_argument<std::string>("--output", "-o")
+		.help("generated .imp file (default: stdout)");
+
+	try
+	{
+		parser.parse_args(argc, argv);
+	}
+	catch(const std::exception& e)
+	{
+		std::println(std::cerr, "{}", e.what());
+		std::exit(1);
+	}
+
+	return {
+		.family = gen::familyFromString(parser.get<std::string>("family")),
+		.size = static_cast<size_t>(std::max(0, parser.get<int>("size"))),
+		.seed = static_cast<uint32_t>(parser.get<int>("--seed")),
+		.output = parser.is_used("--output") ? parser.get<std::string>("--output") : "",
+	};
+}
+
+
+int main(const int argc, char const * argv[])
+{
+	const Arguments args = parse_args(argc, argv);
+
+	std::string source;
+	if (args.family)
+		source = gen::generateProgram(*args.family, args.size, args.seed);
+	else
+	{
+		// the input and the output of the reference interpreter, in the header format of the benchmark programs
+		const gen::RandomCase random = gen::randomCase(args.seed, args.size);
+		std::vector<std::string> comments = { std::format("generated: random {} (seed {})", args.size, args.seed) };
+		for (const uint64_t value : random.input)
+			comments.push_back(std::format("? {}", value));
+		if (const auto expected = gen::interpret(random.program, random.input))
+		{
+			for (const uint64_t value : expected->output)
+				comments.push_back(std::format("> {}", value));
+		}
+		else
+			comments.push_back("undefined: overflow, index out of range or too long to run");
+		source = gen::print(random.program, comments);
+	}
+
+	if (args.output.empty())
+	{
+		std::print("{}", source);
+		return 0;
+	}
+
+	std::ofstream file(args.output);
+	if (!file)
+	{
+		std::println(std::cerr, "{}Error: could not open '{}'{}", cRed, args.output.string(), cReset);
+		return -1;
+	}
+	file << source;
+
+	std::println("{} {} -> {}", args.family ? gen::familyName(*args.family) : "random", args.size, args.output.string());
+	return 0;
+}
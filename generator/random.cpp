@@ -0,0 +1,414 @@
+#include "random.hpp"
+
+#include <algorithm>
+#include <random>
+
+#include "generator.hpp"
+
+
+namespace gen
+{
+
+	namespace
+	{
+		constexpr size_t max_depth = 3;
+		constexpr uint64_t small_number = 16;
+
+		class Builder
+		{
+		public:
+
+			Builder(const uint32_t seed, const size_t size)
+				: m_rng(seed), m_budget(size)
+			{
+				m_low = pick(4);
+				m_high = m_low + pick(8);
+			}
+
+			RandomCase build()
+			{
+				RandomCase result;
+
+				const size_t procedures = pick(4);
+				for (size_t p = 0; p < procedures; p++)
+					result.program.procedures.push_back(procedure(result.program.procedures, m_budget / (procedures + 2)));
+
+				Scope scope;
+				scope.callable = &result.program.procedures;
+				Block& body = result.program.body;
+
+				// inputs first, the rest starts as constants
+				const size_t scalars = 2 + pick(4);
+				const size_t reads = 1 + pick(std::min<size_t>(scalars, 3));
+				for (size_t k = 0; k < scalars; k++)
+				{
+					const std::string name = fresh("v");
+					result.program.declarations.push_back(Declaration { .name = name });
+					if (k < reads)
+					{
+						body.push_back(Command { .kind = Command::Kind::Read, .target = variable(name) });
+						result.input.push_back(pick(4) == 0 ? 1'000 + pick(1'000'000) : pick(small_number));
+					}
+					else
+						body.push_back(assign(variable(name), Expression { .left = number() }));
+					scope.scalars.push_back(name);
+				}
+
+				const size_t arrays = pick(3);
+				for (size_t k = 0; k < arrays; k++)
+				{
+					const std::string name = fresh("t");
+					result.program.declarations.push_back(Declaration { .name = name, .array = true, .low = m_low, .high = m_high });
+					body.push_back(fill(name, scope));
+					scope.arrays.push_back(name);
+				}
+
+				commands(body, scope, m_budget, 0, &result.program.declarations);
+
+				for (size_t k = 0, writes = 1 + pick(3); k < writes; k++)
+					body.push_back(Command { .kind = Command::Kind::Write, .value = readable(scope) });
+				return result;
+			}
+
+		private:
+
+			struct Scope
+			{
+				std::vector<std::string> scalars;	// initialized and assignable
+				std::vector<std::string> readonly;	// I parameters, loop counters and iterators
+				std::vector<std::string> indices;	// iterators that run over the array range
+				std::vector<std::string> arrays;
+				const std::vector<Procedure>* callable = nullptr;
+			};
+
+			size_t pick(const size_t bound)
+			{
+				return bound == 0 ? 0 : m_rng() % bound;
+			}
+
+			bool chance(const size_t one_in)
+			{
+				return pick(one_in) == 0;
+			}
+
+			template <class T>
+			const T& any(const std::vector<T>& items)
+			{
+				return items[pick(items.size())];
+			}
+
+			std::string fresh(const std::string_view prefix)
+			{
+				return identifier(prefix, m_names++);
+			}
+
+			static Value variable(const std::string& name)
+			{
+				return Value { .kind = Value::Kind::Variable, .name = name };
+			}
+
+			Value number()
+			{
+				return Value { .kind = Value::Kind::Number, .number = chance(5) ? pick(100'000) : pick(small_number) };
+			}
+
+			Value element(const std::string& array, const Scope& scope)
+			{
+				if (!scope.indices.empty() && chance(2))
+					return Value { .kind = Value::Kind::Element, .name = array, .index = any(scope.indices) };
+				return Value { .kind = Value::Kind::Element, .name = array, .index_number = m_low + pick(m_high - m_low + 1) };
+			}
+
+			Value readable(const Scope& scope)
+			{
+				switch (pick(6))
+				{
+				case 0:
+					return number();
+				case 1:
+					if (!scope.arrays.empty())
+						return element(any(scope.arrays), scope);
+					break;
+				case 2:
+					if (!scope.readonly.empty())
+						return variable(any(scope.readonly));
+					break;
+				}
+				return scope.scalars.empty() ? number() : variable(any(scope.scalars));
+			}
+
+			Value assignable(const Scope& scope)
+			{
+				if (!scope.arrays.empty() && (scope.scalars.empty() || chance(3)))
+					return element(any(scope.arrays), scope);
+				return variable(any(scope.scalars));
+			}
+
+			static Command assign(Value target, Expression expression)
+			{
+				return Command { .kind = Command::Kind::Assign, .target = std::move(target), .expression = std::move(expression) };
+			}
+
+			Expression expression(const Scope& scope)
+			{
+				static constexpr char operators[] = { '+', '-', '*', '/', '%' };
+				Expression e { .left = readable(scope) };
+				if (chance(4))
+					return e;
+				e.op = operators[pick(std::size(operators))];
+				// keep products small, so that most programs stay far from overflow
+				e.right = e.op == '*' && chance(2) ? Value { .kind = Value::Kind::Number, .number = pick(small_number) } : readable(scope);
+				return e;
+			}
+
+			Condition condition(const Scope& scope)
+			{
+				static const std::string operators[] = { "=", "!=", ">", "<", ">=", "<=" };
+				return Condition { .left = readable(scope), .op = operators[pick(std::size(operators))], .right = readable(scope) };
+			}
+
+			// t[i] := <value> for every index
+			Command fill(const std::string& array, const Scope& scope)
+			{
+				Scope inner = scope;
+				const std::string iterator = fresh("i");
+				inner.readonly.push_back(iterator);
+				inner.indices.push_back(iterator);
+
+				Command loop = range(iterator);
+				Expression e { .left = variable(iterator), .op = '+', .right = inner.scalars.empty() ? number() : readable(inner) };
+				loop.body.push_back(assign(Value { .kind = Value::Kind::Element, .name = array, .index = iterator }, std::move(e)));
+				return loop;
+			}
+
+			// FOR iterator over the whole array range, in either direction
+			Command range(const std::string& iterator)
+			{
+				const Value low { .kind = Value::Kind::Number, .number = m_low };
+				const Value high { .kind = Value::Kind::Number, .number = m_high };
+				const bool downto = chance(3);
+				return Command { .kind = Command::Kind::For, .iterator = iterator, .from = downto ? high : low, .to = downto ? low : high, .downto = downto };
+			}
+
+			// counter := 0 before the loop and counter := counter + 1 at the end of its body
+			std::string counter(Block& out, std::vector<Declaration>* declarations)
+			{
+				const std::string name = fresh("c");
+				declarations->push_back(Declaration { .name = name });
+				out.push_back(assign(variable(name), Expression { .left = Value { .kind = Value::Kind::Number, .number = 0 } }));
+				return name;
+			}
+
+			void commands(Block& out, const Scope& scope, const size_t budget, const size_t depth, std::vector<Declaration>* declarations)
+			{
+				const size_t count = std::max<size_t>(1, depth == 0 ? budget : std::min<size_t>(budget, 1 + pick(4)));
+				for (size_t k = 0; k < count && m_budget > 0; k++)
+				{
+					m_budget--;
+					command(out, scope, depth, declarations);
+				}
+			}
+
+			Block nested(const Scope& scope, const size_t depth, std::vector<Declaration>* declarations)
+			{
+				Block body;
+				commands(body, scope, std::max<size_t>(1, m_budget / 4), depth + 1, declarations);
+				if (body.empty())
+					body.push_back(assign(assignable(scope), expression(scope)));
+				return body;
+			}
+
+			void command(Block& out, const Scope& scope, const size_t depth, std::vector<Declaration>* declarations)
+			{
+				const bool can_nest = depth < max_depth && m_budget > 1;
+				switch (pick(10))
+				{
+				case 0:
+				case 1:
+					if (can_nest)
+					{
+						Command c { .kind = Command::Kind::If, .condition = condition(scope), .body = nested(scope, depth, declarations) };
+						if (chance(2))
+							c.otherwise = nested(scope, depth, declarations);
+						out.push_back(std::move(c));
+						return;
+					}
+					break;
+				case 2:
+					if (can_nest)
+					{
+						const std::string c = counter(out, declarations);
+						Scope inner = scope;
+						inner.readonly.push_back(c);
+						Command loop {
+							.kind = Command::Kind::While,
+							.condition = Condition { .left = variable(c), .op = "<", .right = Value { .kind = Value::Kind::Number, .number = 1 + pick(4) } },
+							.body = nested(inner, depth, declarations),
+						};
+						loop.body.push_back(assign(variable(c), Expression { .left = variable(c), .op = '+', .right = Value { .kind = Value::Kind::Number, .number = 1 } }));
+						out.push_back(std::move(loop));
+						return;
+					}
+					break;
+				case 3:
+					if (can_nest)
+					{
+						const std::string c = counter(out, declarations);
+						Scope inner = scope;
+						inner.readonly.push_back(c);
+						Command loop {
+							.kind = Command::Kind::Repeat,
+							.condition = Condition { .left = variable(c), .op = ">=", .right = Value { .kind = Value::Kind::Number, .number = 1 + pick(4) } },
+							.body = nested(inner, depth, declarations),
+						};
+						loop.body.push_back(assign(variable(c), Expression { .left = variable(c), .op = '+', .right = Value { .kind = Value::Kind::Number, .number = 1 } }));
+						out.push_back(std::move(loop));
+						return;
+					}
+					break;
+				case 4:
+					if (can_nest)
+					{
+						const std::string iterator = fresh("i");
+						Scope inner = scope;
+						inner.readonly.push_back(iterator);
+						Command loop;
+						if (!scope.arrays.empty() && chance(2))
+						{
+							loop = range(iterator);
+							inner.indices.push_back(iterator);
+						}
+						else
+						{
+							// small, possibly empty ranges; a variable bound may make the loop long
+							const bool downto = chance(3);
+							Value from = chance(3) ? readable(scope) : Value { .kind = Value::Kind::Number, .number = pick(6) };
+							Value to { .kind = Value::Kind::Number, .number = pick(6) };
+							loop = Command { .kind = Command::Kind::For, .iterator = iterator, .from = std::move(from), .to = std::move(to), .downto = downto };
+						}
+						loop.body = nested(inner, depth, declarations);
+						out.push_back(std::move(loop));
+						return;
+					}
+					break;
+				case 5:
+					out.push_back(Command { .kind = Command::Kind::Write, .value = readable(scope) });
+					return;
+				case 6:
+				case 7:
+					if (call(out, scope))
+						return;
+					break;
+				}
+				out.push_back(assign(assignable(scope), expression(scope)));
+			}
+
+			// a call of an earlier procedure with distinct arguments, so that no two parameters alias
+			bool call(Block& out, const Scope& scope)
+			{
+				if (!scope.callable || scope.callable->empty())
+					return false;
+				const Procedure& callee = any(*scope.callable);
+
+				std::vector<std::string> scalars = scope.scalars;
+				std::vector<std::string> readonly = scope.readonly;
+				std::shuffle(scalars.begin(), scalars.end(), m_rng);
+				std::shuffle(readonly.begin(), readonly.end(), m_rng);
+
+				Command c { .kind = Command::Kind::Call, .procedure = callee.name };
+				for (const auto& parameter : callee.parameters)
+				{
+					std::vector<std::string>* source = &scalars;
+					if (parameter.type == Parameter::Type::Array)
+					{
+						if (scope.arrays.empty())
+							return false;
+						c.arguments.push_back(any(scope.arrays));
+						continue;
+					}
+					if (parameter.type == Parameter::Type::Input && !readonly.empty() && (scalars.empty() || chance(2)))
+						source = &readonly;
+					if (source->empty())
+						return false;
+					c.arguments.push_back(source->back());
+					source->pop_back();
+				}
+				out.push_back(std::move(c));
+				return true;
+			}
+
+			Procedure procedure(const std::vector<Procedure>& earlier, const size_t budget)
+			{
+				Procedure p { .name = fresh("p") };
+				Scope scope;
+				scope.callable = &earlier;
+
+				if (chance(2))
+				{
+					p.parameters.push_back(Parameter { .type = Parameter::Type::Array, .name = fresh("a") });
+					scope.arrays.push_back(p.parameters.back().name);
+				}
+				for (size_t k = 0, n = 1 + pick(3); k < n; k++)
+				{
+					static constexpr Parameter::Type types[] = { Parameter::Type::Plain, Parameter::Type::Input, Parameter::Type::Output };
+					const Parameter::Type type = types[pick(std::size(types))];
+					p.parameters.push_back(Parameter { .type = type, .name = fresh("x") });
+					if (type == Parameter::Type::Input)
+						scope.readonly.push_back(p.parameters.back().name);
+					else if (type == Parameter::Type::Plain)
+						scope.scalars.push_back(p.parameters.back().name);
+				}
+
+				// outputs and locals are defined before anything else
+				Scope defined = scope;
+				for (const auto& parameter : p.parameters)
+				{
+					if (parameter.type != Parameter::Type::Output)
+						continue;
+					p.body.push_back(assign(variable(parameter.name), expression(defined)));
+					scope.scalars.push_back(parameter.name);
+				}
+				for (size_t k = 0, n = pick(3); k < n; k++)
+				{
+					const std::string name = fresh("l");
+					p.locals.push_back(Declaration { .name = name });
+					p.body.push_back(assign(variable(name), expression(defined)));
+					scope.scalars.push_back(name);
+				}
+				if (chance(3))
+				{
+					const std::string name = fresh("t");
+					p.locals.push_back(Declaration { .name = name, .array = true, .low = m_low, .high = m_high });
+					p.body.push_back(fill(name, scope));
+					scope.arrays.push_back(name);
+				}
+				if (scope.scalars.empty())
+				{
+					const std::string name = fresh("l");
+					p.locals.push_back(Declaration { .name = name });
+					p.body.push_back(assign(variable(name), Expression { .left = number() }));
+					scope.scalars.push_back(name);
+				}
+
+				const size_t saved = m_budget;
+				m_budget = std::max<size_t>(budget, 1);
+				commands(p.body, scope, m_budget, 0, &p.locals);
+				m_budget = saved > budget ? saved - budget : 1;
+				return p;
+			}
+
+			std::mt19937 m_rng;
+			size_t m_budget;
+			size_t m_names = 0;
+			uint64_t m_low = 0;
+			uint64_t m_high = 0;
+		};
+	}
+
+
+	RandomCase randomCase(const uint32_t seed, const size_t size)
+	{
+		return Builder(seed, std::max<size_t>(size, 1)).build();
+	}
+
+} // namespace gen
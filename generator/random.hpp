@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "imp.hpp"
+
+
+namespace gen
+{
+
+struct RandomCase
+{
+	Program program;
+	std::vector<uint64_t> input;
+};
+
+/**
+ * @brief Generates a random, well-formed program with about `size` commands, and an input for it.
+ *
+ * @details
+ * Every variable is initialized before use, every procedure only calls earlier ones, and every
+ * WHILE and REPEAT loop runs on its own counter, so almost all generated programs terminate and
+ * are defined; the rest (overflow, an out-of-range index, a long FOR loop) is for the interpreter to reject.
+ * All arrays share one index range, so any array can be passed to any procedure.
+ */
+RandomCase randomCase(uint32_t seed, size_t size);
+
+} // namespace gen
@@ -0,0 +1,150 @@
+#include "reduce.hpp"
+
+#include <utility>
+#include <vector>
+
+
+namespace gen
+{
+
+	namespace
+	{
+		// position of a command: the block it is in and its index there
+		using Slot = std::pair<Block*, size_t>;
+
+		void collect(Block& block, std::vector<Slot>& slots)
+		{
+			for (size_t i = 0; i < block.size(); i++)
+			{
+				slots.emplace_back(&block, i);
+				collect(block[i].body, slots);
+				collect(block[i].otherwise, slots);
+			}
+		}
+
+		// every command of the program in a fixed pre-order, procedures first
+		std::vector<Slot> slots(Program& program)
+		{
+			std::vector<Slot> result;
+			for (auto& procedure : program.procedures)
+				collect(procedure.body, result);
+			collect(program.body, result);
+			return result;
+		}
+
+		enum class Change
+		{
+			Remove,
+			Unwrap,			// the body of IF, WHILE, REPEAT or FOR in place of the command
+			Otherwise,		// the ELSE branch in place of the IF
+			KeepLeft,		// x := a op b  ->  x := a
+			KeepRight,		// x := a op b  ->  x := b
+		};
+
+		constexpr Change changes[] = { Change::Remove, Change::Unwrap, Change::Otherwise, Change::KeepLeft, Change::KeepRight };
+
+		// applies the change to the n-th command; false if it does not apply to that command
+		bool apply(Program& program, const size_t n, const Change change)
+		{
+			auto all = slots(program);
+			if (n >= all.size())
+				return false;
+			auto [block, index] = all[n];
+			Command& command = (*block)[index];
+
+			switch (change)
+			{
+			case Change::Remove:
+				block->erase(block->begin() + index);
+				return true;
+			case Change::Unwrap:
+			{
+				if (command.body.empty())
+					return false;
+				Block body = std::move(command.body);
+				block->erase(block->begin() + index);
+				block->insert(block->begin() + index, std::make_move_iterator(body.begin()), std::make_move_iterator(body.end()));
+				return true;
+			}
+			case Change::Otherwise:
+			{
+				if (command.otherwise.empty())
+					return false;
+				Block otherwise = std::move(command.otherwise);
+				block->erase(block->begin() + index);
+				block->insert(block->begin() + index, std::make_move_iterator(otherwise.begin()), std::make_move_iterator(otherwise.end()));
+				return true;
+			}
+			case Change::KeepLeft:
+			case Change::KeepRight:
+				if (command.kind != Command::Kind::Assign || command.expression.op == 0)
+					return false;
+				if (change == Change::KeepRight)
+					command.expression.left = command.expression.right;
+				command.expression.op = 0;
+				return true;
+			}
+			return false;
+		}
+	}
+
+
+	Program reduce(Program program, const std::function<bool(const Program&)>& failing, const size_t max_attempts)
+	{
+		size_t attempts = 0;
+		bool progress = true;
+		while (progress && attempts < max_attempts)
+		{
+			progress = false;
+
+			// whole procedures first, they are the biggest steps
+			for (size_t p = program.procedures.size(); p-- > 0 && attempts < max_attempts; )
+			{
+				Program candidate = program;
+				candidate.procedures.erase(candidate.procedures.begin() + p);
+				attempts++;
+				if (failing(candidate))
+				{
+					program = std::move(candidate);
+					progress = true;
+				}
+			}
+
+			// the last commands first, so that a removal does not shift the ones still to try
+			for (size_t n = slots(program).size(); n-- > 0 && attempts < max_attempts; )
+			{
+				for (const Change change : changes)
+				{
+					Program candidate = program;
+					if (!apply(candidate, n, change))
+						continue;
+					attempts++;
+					if (failing(candidate))
+					{
+						program = std::move(candidate);
+						progress = true;
+						break;
+					}
+				}
+			}
+
+			// declarations the remaining commands no longer use
+			auto prune = [&](auto declarations_of) {
+				for (size_t d = declarations_of(program).size(); d-- > 0 && attempts < max_attempts; )
+				{
+					Program candidate = program;
+					auto& declarations = declarations_of(candidate);
+					declarations.erase(declarations.begin() + d);
+					attempts++;
+					if (failing(candidate))
+						program = std::move(candidate);
+				}
+			};
+			for (size_t p = 0; p < program.procedures.size(); p++)
+				prune([p](Program& in) -> std::vector<Declaration>& { return in.procedures[p].locals; });
+			prune([](Program& in) -> std::vector<Declaration>& { return in.declarations; });
+		}
+		return program;
+	}
+
+} // namespace gen
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <functional>
+
+#include "imp.hpp"
+
+
+namespace gen
+{
+
+/**
+ * @brief Shrinks a program while `failing` still holds for it.
+ *
+ * @details
+ * Greedily removes commands, replaces IF and loops by their bodies, IF by its ELSE branch and
+ * binary expressions by one of their operands, and drops whole procedures and unused declarations,
+ * until no single change keeps the failure or `max_attempts` candidates were tried.
+ * `failing` is expected to reject programs that are no longer valid (see gen::interpret),
+ * so the result stays a valid program.
+ */
+Program reduce(Program program, const std::function<bool(const Program&)>& failing, size_t max_attempts = 2'000);
+
+} // namespace gen
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <expected>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#include "../instructions.hpp"
+#include "../vm/loader.hpp"
+
+
+// A .mr program as written, before decoding
+struct SourceProgram
+{
+	std::vector<std::pair<int, var_t>> instructions;
+	std::vector<int> lines;		// lines[i] is the source line of instructions[i]
+};
+
+/**
+ * @brief Parses a .mr file with the bison grammar.
+ *
+ * @details
+ * The parser and the scanner keep all of their state in locals, so any number of threads may load programs at once.
+ * Unlike vm::loadProgram() the operands are not checked; use it when the raw (opcode, operand) pairs are needed.
+ */
+std::expected<SourceProgram, vm::LoadError> load_program(const std::filesystem::path& filename);
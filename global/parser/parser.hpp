@@ -1,93 +0,0 @@
-/* A Bison parser, made by GNU Bison 3.8.2.  */
-
-/* Bison interface for Yacc-like parsers in C
-
-   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
-   Inc.
-
-   This program is free software: you can redistribute it and/or modify
-   it under the terms of the GNU General Public License as published by
-   the Free Software Foundation, either version 3 of the License, or
-   (at your option) any later version.
-
-   This program is distributed in the hope that it will be useful,
-   but WITHOUT ANY WARRANTY; without even the implied warranty of
-   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-   GNU General Public License for more details.
-
-   You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
-
-/* As a special exception, you may create a larger work that contains
-   part or all of the Bison parser skeleton and distribute that work
-   under terms of your choice, so long as that work isn't itself a
-   parser generator using the skeleton or a modified version thereof
-   as a parser skeleton.  Alternatively, if you modify or redistribute
-   the parser skeleton itself, you may (at your option) remove this
-   special exception, which will cause the skeleton and the resulting
-   Bison output files to be licensed under the GNU General Public
-   License without this special exception.
-
-   This special exception was added by the Free Software Foundation in
-   version 2.2 of Bison.  */
-
-/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
-   especially those whose name start with YY_ or yy_.  They are
-   private implementation details that can be changed or removed.  */
-
-#ifndef YY_YY_HOME_ADAMK_COMPILER_FLTT_COMPILER_TOOLS_GLOBAL_PARSER_PARSER_HPP_INCLUDED
-# define YY_YY_HOME_ADAMK_COMPILER_FLTT_COMPILER_TOOLS_GLOBAL_PARSER_PARSER_HPP_INCLUDED
-/* Debug traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-#if YYDEBUG
-extern int yydebug;
-#endif
-/* "%code requires" blocks.  */
-#line 10 "/home/adamk/compiler/fltt-compiler-tools/global/parser/parser.y"
- 
-#include<vector> 
-#include<utility>
-#include "../instructions.hpp"
-
-#define YYSTYPE var_t
-
-#line 57 "/home/adamk/compiler/fltt-compiler-tools/global/parser/parser.hpp"
-
-/* Token kinds.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-  enum yytokentype
-  {
-    YYEMPTY = -2,
-    YYEOF = 0,                     /* "end of file"  */
-    YYerror = 256,                 /* error  */
-    YYUNDEF = 257,                 /* "invalid token"  */
-    COM_0 = 258,                   /* COM_0  */
-    COM_1 = 259,                   /* COM_1  */
-    JUMP_0 = 260,                  /* JUMP_0  */
-    JUMP_1 = 261,                  /* JUMP_1  */
-    STOP = 262,                    /* STOP  */
-    REG = 263,                     /* REG  */
-    NUMBER = 264,                  /* NUMBER  */
-    ERROR = 265                    /* ERROR  */
-  };
-  typedef enum yytokentype yytoken_kind_t;
-#endif
-
-/* Value type.  */
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef int YYSTYPE;
-# define YYSTYPE_IS_TRIVIAL 1
-# define YYSTYPE_IS_DECLARED 1
-#endif
-
-
-extern YYSTYPE yylval;
-
-
-int yyparse (std::vector<std::pair<int,var_t>>& program);
-
-
-#endif /* !YY_YY_HOME_ADAMK_COMPILER_FLTT_COMPILER_TOOLS_GLOBAL_PARSER_PARSER_HPP_INCLUDED  */
@@ -8,64 +8,101 @@
  * Modified by Adam Kostrzewski
 */
 %code requires { 
-#include<vector> 
-#include<utility>
+#include <optional>
+#include <vector>
+#include <utility>
 #include "../instructions.hpp"
+#include "load.hpp"
 
 #define YYSTYPE var_t
+typedef void* yyscan_t;
+
+// everything a single parse writes to
+struct ParseState
+{
+	SourceProgram program;
+	std::optional<vm::LoadError> error;
+};
 }
-%{
-#include <iostream>
+%code {
+#include <cstdio>
+#include <format>
 #include <utility>
 #include <vector>
-#include <print>
 
 #include "../instructions.hpp"
-#include "../colors.hpp"
-
-extern int yylineno;
-int yylex();
-void yyset_in(FILE* in_str);
-void yyerror(std::vector<std::pair<int,var_t>>& program, char const *s);
 
-%}
-%parse-param { std::vector<std::pair<int,var_t>>& program }
+int yylex(YYSTYPE* yylval, YYLTYPE* yylloc, yyscan_t scanner);
+int yylex_init(yyscan_t* scanner);
+int yylex_destroy(yyscan_t scanner);
+void yyset_in(FILE* in_str, yyscan_t scanner);
+void yyerror(YYLTYPE* location, yyscan_t scanner, ParseState& state, char const *s);
+}
+%define api.pure full
+%define parse.error detailed
+%locations
+%param { yyscan_t scanner }
+%parse-param { ParseState& state }
 %token COM_0
 %token COM_1
 %token JUMP_0
 %token JUMP_1
 %token STOP
-%token REG
-%token NUMBER
-%token ERROR
+%token REG "register"
+%token NUMBER "number"
+%token ERROR "unrecognised symbol"
 %%
 input 
-	: input line
+	: input line	{ state.program.lines.push_back(@2.last_line); }
 	| %empty
 	;
 
 line 
-	: COM_0	  		{ program.push_back(std::make_pair($1,0));   }
-	| COM_1 REG	  	{ program.push_back(std::make_pair($1,$2));  }
-	| COM_1 NUMBER  { program.push_back(std::make_pair($1,$2));  }
-	| JUMP_0        { program.push_back(std::make_pair($1,0));   }
-	| JUMP_1 NUMBER { program.push_back(std::make_pair($1,$2));  }
-	| STOP          { program.push_back(std::make_pair($1,0));   }
-	| ERROR         { yyerror(program, "Symbol not recognised"); }
+	: COM_0	  		{ state.program.instructions.push_back(std::make_pair($1,0));   }
+	| COM_1 REG	  	{ state.program.instructions.push_back(std::make_pair($1,$2));  }
+	| COM_1 NUMBER  { state.program.instructions.push_back(std::make_pair($1,$2));  }
+	| JUMP_0        { state.program.instructions.push_back(std::make_pair($1,0));   }
+	| JUMP_1 NUMBER { state.program.instructions.push_back(std::make_pair($1,$2));  }
+	| STOP          { state.program.instructions.push_back(std::make_pair($1,0));   }
+	| ERROR
+		{
+			state.error = vm::LoadError { .kind = vm::LoadError::Kind::Symbol, .line = @1.first_line, .column = @1.first_column, .message = "symbol not recognised" };
+			YYABORT;
+		}
 	;
 %%
 
-void yyerror(std::vector<std::pair<int, var_t>>& program, char const *s)
+void yyerror(YYLTYPE* location, yyscan_t scanner, ParseState& state, char const *s)
 {
-	std::println(std::cerr, "{}Line {}: {}{}", cRed, yylineno, s, cReset);
-	std::exit(-1);
+	if (!state.error)
+		state.error = vm::LoadError { .kind = vm::LoadError::Kind::Syntax, .line = location->first_line, .column = location->first_column, .message = s };
 }
 
-void run_parser(std::vector<std::pair<int,var_t>>& program, FILE* data ) 
+std::expected<SourceProgram, vm::LoadError> load_program(const std::filesystem::path& filename)
 {
-	/* std::println("{}Reading the code{}", cBlue, cReset); */
-	yyset_in(data);
-	yyparse(program);
-	/* std::println("{}Finished reading the code (instructions: {}){}", cBlue, program.size(), cReset); */
+	FILE* data = std::fopen(filename.c_str(), "r");
+	if (!data)
+		return std::unexpected(vm::LoadError { .kind = vm::LoadError::Kind::Io, .line = 0, .column = 0, .message = std::format("could not open '{}'", filename.string()) });
+
+	yyscan_t scanner;
+	if (yylex_init(&scanner) != 0)
+	{
+		std::fclose(data);
+		return std::unexpected(vm::LoadError { .kind = vm::LoadError::Kind::Io, .line = 0, .column = 0, .message = "could not create the scanner" });
+	}
+	yyset_in(data, scanner);
+
+	ParseState state;
+	const int status = yyparse(scanner, state);
+
+	yylex_destroy(scanner);
+	std::fclose(data);
+
+	if (state.error)
+		return std::unexpected(std::move(*state.error));
+	if (status != 0)
+		return std::unexpected(vm::LoadError { .kind = vm::LoadError::Kind::Io, .line = 0, .column = 0, .message = "the parser ran out of memory" });
+
+	return std::move(state.program);
 }
 
@@ -0,0 +1,280 @@
+#include "bigword.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+
+namespace vm
+{
+
+	namespace
+	{
+		using Magnitude = std::vector<uint32_t>;
+
+		void trim(Magnitude& m)
+		{
+			while (!m.empty() && m.back() == 0)
+				m.pop_back();
+		}
+
+		int compareMagnitude(const Magnitude& a, const Magnitude& b)
+		{
+			if (a.size() != b.size())
+				return a.size() < b.size() ? -1 : 1;
+			for (size_t i = a.size(); i-- > 0; )
+			{
+				if (a[i] != b[i])
+					return a[i] < b[i] ? -1 : 1;
+			}
+			return 0;
+		}
+
+		Magnitude addMagnitude(const Magnitude& a, const Magnitude& b)
+		{
+			Magnitude sum(std::max(a.size(), b.size()) + 1, 0);
+			uint64_t carry = 0;
+			for (size_t i = 0; i < sum.size(); i++)
+			{
+				carry += (i < a.size() ? a[i] : 0);
+				carry += (i < b.size() ? b[i] : 0);
+				sum[i] = static_cast<uint32_t>(carry);
+				carry >>= 32;
+			}
+			trim(sum);
+			return sum;
+		}
+
+		// a - b, requires a >= b
+		Magnitude subtractMagnitude(const Magnitude& a, const Magnitude& b)
+		{
+			Magnitude difference(a.size(), 0);
+			int64_t borrow = 0;
+			for (size_t i = 0; i < a.size(); i++)
+			{
+				int64_t d = static_cast<int64_t>(a[i]) - (i < b.size() ? b[i] : 0) - borrow;
+				borrow = d < 0;
+				difference[i] = static_cast<uint32_t>(d + (borrow << 32));
+			}
+			trim(difference);
+			return difference;
+		}
+
+		void shiftLeftOne(Magnitude& m)
+		{
+			uint32_t carry = 0;
+			for (uint32_t& limb : m)
+			{
+				const uint32_t next = limb >> 31;
+				limb = (limb << 1) | carry;
+				carry = next;
+			}
+			if (carry)
+				m.push_back(carry);
+		}
+
+		// returns the bit shifted out
+		bool shiftRightOne(Magnitude& m)
+		{
+			const bool low = !m.empty() && (m[0] & 1);
+			uint32_t carry = 0;
+			for (size_t i = m.size(); i-- > 0; )
+			{
+				const uint32_t next = m[i] & 1;
+				m[i] = (m[i] >> 1) | (carry << 31);
+				carry = next;
+			}
+			trim(m);
+			return low;
+		}
+
+		// m = m * factor + addend
+		void multiplyAdd(Magnitude& m, const uint32_t factor, uint32_t addend)
+		{
+			uint64_t carry = addend;
+			for (uint32_t& limb : m)
+			{
+				carry += static_cast<uint64_t>(limb) * factor;
+				limb = static_cast<uint32_t>(carry);
+				carry >>= 32;
+			}
+			if (carry)
+				m.push_back(static_cast<uint32_t>(carry));
+		}
+
+		// m /= divisor, returns the remainder
+		uint32_t divide(Magnitude& m, const uint32_t divisor)
+		{
+			uint64_t remainder = 0;
+			for (size_t i = m.size(); i-- > 0; )
+			{
+				const uint64_t current = (remainder << 32) | m[i];
+				m[i] = static_cast<uint32_t>(current / divisor);
+				remainder = current % divisor;
+			}
+			trim(m);
+			return static_cast<uint32_t>(remainder);
+		}
+	}
+
+
+	void BigWord::unpack(bool& negative, Magnitude& magnitude) const
+	{
+		if (!isSmall())
+		{
+			negative = m_negative;
+			magnitude = m_magnitude;
+			return;
+		}
+
+		negative = m_small < 0;
+		// two's complement negation in unsigned arithmetic also covers INT64_MIN
+		const uint64_t absolute = negative ? 0 - static_cast<uint64_t>(m_small) : static_cast<uint64_t>(m_small);
+		magnitude = { static_cast<uint32_t>(absolute), static_cast<uint32_t>(absolute >> 32) };
+		trim(magnitude);
+	}
+
+	BigWord BigWord::pack(const bool negative, Magnitude magnitude)
+	{
+		trim(magnitude);
+
+		if (magnitude.size() <= 2)
+		{
+			const uint64_t absolute = (magnitude.size() > 0 ? magnitude[0] : 0) | (magnitude.size() > 1 ? static_cast<uint64_t>(magnitude[1]) << 32 : 0);
+			constexpr uint64_t max = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+			if (!negative && absolute <= max)
+				return BigWord(static_cast<int64_t>(absolute));
+			if (negative && absolute <= max + 1)
+				return BigWord(static_cast<int64_t>(0 - absolute));
+		}
+
+		BigWord result;
+		result.m_negative = negative;
+		result.m_magnitude = std::move(magnitude);
+		return result;
+	}
+
+	BigWord BigWord::addSlow(const BigWord& a, const BigWord& b, const bool subtract)
+	{
+		bool a_negative, b_negative;
+		Magnitude a_magnitude, b_magnitude;
+		a.unpack(a_negative, a_magnitude);
+		b.unpack(b_negative, b_magnitude);
+		if (subtract)
+			b_negative = !b_negative;
+
+		if (a_negative == b_negative)
+			return pack(a_negative, addMagnitude(a_magnitude, b_magnitude));
+
+		if (compareMagnitude(a_magnitude, b_magnitude) >= 0)
+			return pack(a_negative, subtractMagnitude(a_magnitude, b_magnitude));
+		return pack(b_negative, subtractMagnitude(b_magnitude, a_magnitude));
+	}
+
+	std::strong_ordering BigWord::compareSlow(const BigWord& a, const BigWord& b)
+	{
+		bool a_negative, b_negative;
+		Magnitude a_magnitude, b_magnitude;
+		a.unpack(a_negative, a_magnitude);
+		b.unpack(b_negative, b_magnitude);
+
+		if (a_negative != b_negative)
+			return a_negative ? std::strong_ordering::less : std::strong_ordering::greater;
+
+		const int magnitude = compareMagnitude(a_magnitude, b_magnitude);
+		const int sign = a_negative ? -magnitude : magnitude;
+		return sign < 0 ? std::strong_ordering::less : sign > 0 ? std::strong_ordering::greater : std::strong_ordering::equal;
+	}
+
+	BigWord& BigWord::operator<<=(const int bits)
+	{
+		for (int i = 0; i < bits; i++)
+		{
+			if (isSmall() && m_small >= std::numeric_limits<int64_t>::min() / 2 && m_small <= std::numeric_limits<int64_t>::max() / 2) [[likely]]
+			{
+				m_small *= 2;
+				continue;
+			}
+
+			bool negative;
+			Magnitude magnitude;
+			unpack(negative, magnitude);
+			shiftLeftOne(magnitude);
+			*this = pack(negative, std::move(magnitude));
+		}
+		return *this;
+	}
+
+	BigWord& BigWord::operator>>=(const int bits)
+	{
+		for (int i = 0; i < bits; i++)
+		{
+			if (isSmall()) [[likely]]
+			{
+				m_small >>= 1;
+				continue;
+			}
+
+			bool negative;
+			Magnitude magnitude;
+			unpack(negative, magnitude);
+			// floor division: a negative odd value rounds away from zero
+			if (shiftRightOne(magnitude) && negative)
+				magnitude = addMagnitude(magnitude, { 1 });
+			*this = pack(negative, std::move(magnitude));
+		}
+		return *this;
+	}
+
+	std::string BigWord::toString() const
+	{
+		if (isSmall())
+			return std::to_string(m_small);
+
+		Magnitude magnitude = m_magnitude;
+		std::string digits;
+		while (!magnitude.empty())
+		{
+			uint32_t chunk = divide(magnitude, 1'000'000'000);
+			for (int i = 0; i < 9 && (chunk != 0 || !magnitude.empty()); i++)
+			{
+				digits.push_back(static_cast<char>('0' + chunk % 10));
+				chunk /= 10;
+			}
+		}
+		if (m_negative)
+			digits.push_back('-');
+		std::reverse(digits.begin(), digits.end());
+		return digits;
+	}
+
+	std::optional<BigWord> BigWord::parse(std::string_view text)
+	{
+		bool negative = false;
+		if (!text.empty() && (text[0] == '-' || text[0] == '+'))
+		{
+			negative = text[0] == '-';
+			text.remove_prefix(1);
+		}
+		if (text.empty())
+			return std::nullopt;
+
+		Magnitude magnitude;
+		for (const char c : text)
+		{
+			if (c < '0' || c > '9')
+				return std::nullopt;
+			multiplyAdd(magnitude, 10, static_cast<uint32_t>(c - '0'));
+		}
+		return pack(negative, std::move(magnitude));
+	}
+
+	size_t BigWord::hash() const
+	{
+		size_t seed = std::hash<int64_t>{}(m_small);
+		for (const uint32_t limb : m_magnitude)
+			seed ^= std::hash<uint32_t>{}(limb) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+		return seed ^ static_cast<size_t>(m_negative);
+	}
+
+} // namespace vm
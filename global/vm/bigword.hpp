@@ -0,0 +1,96 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace vm
+{
+
+/**
+ * @brief Arbitrary-precision signed integer for the bignum VM.
+ *
+ * @details
+ * Values that fit into 64 bits are kept inline and handled with overflow-checked machine arithmetic;
+ * only a result that overflows is promoted to a heap magnitude, and every result that fits again is
+ * demoted, so the representation is unique. Only the operations the VM needs are provided
+ * (add, clamped subtract via `-=`, increment/decrement, shift by one, comparison).
+ */
+class BigWord
+{
+private:
+
+	int64_t m_small = 0;
+	bool m_negative = false;			// sign of a promoted value
+	std::vector<uint32_t> m_magnitude;	// little-endian limbs; empty while the value fits into m_small
+
+public:
+
+	BigWord() = default;
+	BigWord(const long long value) : m_small(value) {}
+
+	bool isSmall() const { return m_magnitude.empty(); }
+	int64_t small() const { return m_small; }
+
+	BigWord& operator+=(const BigWord& other)
+	{
+		int64_t result;
+		if (isSmall() && other.isSmall() && !__builtin_add_overflow(m_small, other.m_small, &result)) [[likely]]
+			m_small = result;
+		else
+			*this = addSlow(*this, other, false);
+		return *this;
+	}
+
+	BigWord& operator-=(const BigWord& other)
+	{
+		int64_t result;
+		if (isSmall() && other.isSmall() && !__builtin_sub_overflow(m_small, other.m_small, &result)) [[likely]]
+			m_small = result;
+		else
+			*this = addSlow(*this, other, true);
+		return *this;
+	}
+
+	BigWord& operator++() { return *this += BigWord(1); }
+	BigWord& operator--() { return *this -= BigWord(1); }
+	BigWord operator++(int) { BigWord old = *this; ++*this; return old; }
+	BigWord operator--(int) { BigWord old = *this; --*this; return old; }
+
+	// only shifts by one are needed by the VM; right shift rounds towards negative infinity like `>>` on int64
+	BigWord& operator<<=(const int bits);
+	BigWord& operator>>=(const int bits);
+
+	friend bool operator==(const BigWord& a, const BigWord& b)
+	{
+		return a.m_small == b.m_small && a.m_negative == b.m_negative && a.m_magnitude == b.m_magnitude;
+	}
+
+	friend std::strong_ordering operator<=>(const BigWord& a, const BigWord& b)
+	{
+		if (a.isSmall() && b.isSmall()) [[likely]]
+			return a.m_small <=> b.m_small;
+		return compareSlow(a, b);
+	}
+
+	std::string toString() const;
+	static std::optional<BigWord> parse(std::string_view text);
+
+	size_t hash() const;
+
+private:
+
+	static BigWord addSlow(const BigWord& a, const BigWord& b, bool subtract);
+	static std::strong_ordering compareSlow(const BigWord& a, const BigWord& b);
+
+	// sign/magnitude view of any value
+	void unpack(bool& negative, std::vector<uint32_t>& magnitude) const;
+	static BigWord pack(bool negative, std::vector<uint32_t> magnitude);
+};
+
+} // namespace vm
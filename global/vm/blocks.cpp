@@ -0,0 +1,53 @@
+#include "program.hpp"
+
+#include <cstddef>
+
+
+namespace vm
+{
+
+	void buildBlocks(Program& program)
+	{
+		const auto& code = program.code;
+		const size_t size = code.size();
+
+		// leaders: program start, jump targets and everything following a control instruction
+		std::vector<bool> leader(size + 1, false);
+		leader[0] = true;
+		leader[size] = true;
+
+		for (size_t pc = 0; pc < size; pc++)
+		{
+			const Instruction& ins = code[pc];
+			if (!isControl(ins.op))
+				continue;
+
+			leader[pc + 1] = true;
+			if (ins.op == Op::JUMP || ins.op == Op::JPOS || ins.op == Op::JZERO || ins.op == Op::CALL)
+				leader[ins.arg] = true;
+		}
+
+		program.blocks.clear();
+		for (size_t pc = 0; pc < size; )
+		{
+			BasicBlock block { .start = static_cast<uint32_t>(pc), .end = 0, .cost = 0 };
+			do
+			{
+				block.cost += instructionCost(code[pc].op);
+				pc++;
+			} while (!leader[pc]);
+			block.end = static_cast<uint32_t>(pc);
+
+			program.blocks.push_back(block);
+		}
+
+		// runs continue through fallthrough edges until the first control instruction
+		program.entry_cost.assign(size + 1, 0);
+		for (size_t pc = size; pc-- > 0; )
+		{
+			const Op op = code[pc].op;
+			program.entry_cost[pc] = instructionCost(op) + (isControl(op) ? 0 : program.entry_cost[pc + 1]);
+		}
+	}
+
+} // namespace vm
@@ -0,0 +1,108 @@
+#include "program.hpp"
+
+#include <format>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+
+namespace vm
+{
+
+	Program decode(const std::vector<std::pair<int, var_t>>& source, const std::vector<int>& lines)
+	{
+		if (const auto errors = verifyJumps(source, lines); !errors.empty())
+			throw std::runtime_error(describeJumpErrors(errors));
+
+		Program program;
+		program.code.reserve(source.size());
+
+		for (size_t i = 0; i < source.size(); i++)
+		{
+			const auto& [opcode, operand] = source[i];
+
+			if (opcode < READ || opcode > HALT)
+				throw std::runtime_error(std::format("instruction {}: unknown opcode {}", i, opcode));
+
+			Instruction ins { .op = static_cast<Op>(opcode), .reg = 0, .aux = 0, .arg = 0 };
+
+			switch (ins.op)
+			{
+			case Op::READ:
+			case Op::WRITE:
+			case Op::RTRN:
+			case Op::HALT:
+				break;
+
+			case Op::LOAD:
+			case Op::STORE:
+				if (operand < 0 || operand > std::numeric_limits<uint32_t>::max())
+					throw std::runtime_error(std::format("instruction {}: memory address {} out of range", i, operand));
+				ins.arg = static_cast<uint32_t>(operand);
+				break;
+
+			case Op::RLOAD:
+			case Op::RSTORE:
+			case Op::ADD:
+			case Op::SUB:
+			case Op::SWP:
+			case Op::RST:
+			case Op::INC:
+			case Op::DEC:
+			case Op::SHL:
+			case Op::SHR:
+				if (operand < 0 || operand >= 8)
+					throw std::runtime_error(std::format("instruction {}: register {} does not exist", i, operand));
+				ins.reg = static_cast<uint8_t>(operand);
+				break;
+
+			case Op::JUMP:
+			case Op::JPOS:
+			case Op::JZERO:
+			case Op::CALL:
+				// validated by verifyJumps()
+				ins.arg = static_cast<uint32_t>(operand);
+				break;
+			}
+
+			program.code.push_back(ins);
+		}
+
+		buildBlocks(program);
+
+		return program;
+	}
+
+	std::string disassemble(const Instruction& instruction)
+	{
+		const std::string_view name = op_names[static_cast<size_t>(instruction.op)];
+		const char reg = static_cast<char>('a' + instruction.reg);
+
+		switch (instruction.op)
+		{
+		case Op::READ:
+		case Op::WRITE:
+		case Op::RTRN:
+		case Op::HALT:
+			return std::string(name);
+
+		case Op::LOAD:
+		case Op::STORE:
+		case Op::JUMP:
+		case Op::JPOS:
+		case Op::JZERO:
+		case Op::CALL:
+			return std::format("{} {}", name, instruction.arg);
+
+		case Op::SET:
+		case Op::LOAD_SWP:
+		case Op::SUB_JZERO:
+		case Op::SUB_JPOS:
+			return std::format("{} {} {} {}", name, reg, instruction.aux, instruction.arg);
+
+		default:
+			return std::format("{} {}", name, reg);
+		}
+	}
+
+} // namespace vm
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string_view>
+#include <optional>
+
+
+namespace vm
+{
+
+// Execution strategy. All engines produce identical cost and output.
+enum class Engine
+{
+	Switch,		// vm::Machine with SwitchDispatch: one central switch per instruction
+	Threaded,	// vm::Machine with ThreadedDispatch (labels-as-values), the same as Switch on other compilers
+	Jit,		// native x86-64 code (vm::JitProgram), falls back to Threaded elsewhere
+};
+
+
+inline std::optional<Engine> engineFromString(const std::string_view name)
+{
+	if (name == "switch")
+		return Engine::Switch;
+	if (name == "threaded")
+		return Engine::Threaded;
+	if (name == "jit")
+		return Engine::Jit;
+	return std::nullopt;
+}
+
+} // namespace vm
@@ -0,0 +1,91 @@
+#include "program.hpp"
+
+#include <cstddef>
+#include <limits>
+
+
+namespace vm
+{
+
+	// RST x; {INC x | SHL x}...  returns the number of fused instructions.
+	// Stops before the constant would leave the int64 range, so SET means the same for every word type.
+	static size_t fuseConstant(Program& program, const size_t pc, const size_t block_end)
+	{
+		auto& code = program.code;
+		const uint8_t reg = code[pc].reg;
+
+		var_t value = 0;
+		size_t end = pc + 1;
+		while (end < block_end && end - pc < std::numeric_limits<uint16_t>::max() && code[end].reg == reg)
+		{
+			if (code[end].op == Op::INC && value < std::numeric_limits<var_t>::max())
+				value++;
+			else if (code[end].op == Op::SHL && value <= std::numeric_limits<var_t>::max() / 2)
+				value <<= 1;
+			else
+				break;
+			end++;
+		}
+
+		if (end - pc < 2)
+			return 1;
+
+		code[pc] = Instruction {
+			.op = Op::SET,
+			.reg = reg,
+			.aux = static_cast<uint16_t>(end - pc),
+			.arg = static_cast<uint32_t>(program.constants.size()),
+		};
+		program.constants.push_back(value);
+		return end - pc;
+	}
+
+	void fuse(Program& program)
+	{
+		auto& code = program.code;
+
+		for (const BasicBlock& block : program.blocks)
+		{
+			for (size_t pc = block.start; pc < block.end; )
+			{
+				const Instruction ins = code[pc];
+				const bool has_next = pc + 1 < block.end;
+				size_t length = 1;
+
+				switch (ins.op)
+				{
+				case Op::RST:
+					length = fuseConstant(program, pc, block.end);
+					break;
+
+				case Op::LOAD:
+					if (has_next && code[pc + 1].op == Op::SWP)
+					{
+						code[pc] = Instruction { .op = Op::LOAD_SWP, .reg = code[pc + 1].reg, .aux = 0, .arg = ins.arg };
+						length = 2;
+					}
+					break;
+
+				case Op::SUB:
+					if (has_next && code[pc + 1].op == Op::JZERO)
+					{
+						code[pc] = Instruction { .op = Op::SUB_JZERO, .reg = ins.reg, .aux = 0, .arg = code[pc + 1].arg };
+						length = 2;
+					}
+					else if (has_next && code[pc + 1].op == Op::JPOS)
+					{
+						code[pc] = Instruction { .op = Op::SUB_JPOS, .reg = ins.reg, .aux = 0, .arg = code[pc + 1].arg };
+						length = 2;
+					}
+					break;
+
+				default:
+					break;
+				}
+
+				pc += length;
+			}
+		}
+	}
+
+} // namespace vm
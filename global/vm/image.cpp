@@ -0,0 +1,222 @@
+#include "image.hpp"
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+
+namespace vm
+{
+
+	namespace
+	{
+		constexpr size_t align8(const size_t size)
+		{
+			return (size + 7) & ~size_t(7);
+		}
+
+		// byte offsets of the sections of an image with the given counts
+		struct Layout
+		{
+			size_t code;
+			size_t blocks;
+			size_t entry_cost;
+			size_t lines;
+			size_t end;
+
+			Layout(const size_t instructions, const size_t block_count, const bool has_lines)
+			{
+				code = sizeof(ImageHeader);
+				blocks = code + instructions * sizeof(Instruction);
+				entry_cost = blocks + block_count * sizeof(BasicBlock);
+				lines = entry_cost + (instructions + 1) * sizeof(var_t);
+				end = lines + (has_lines ? align8(instructions * sizeof(int32_t)) : 0);
+			}
+		};
+
+		template <typename T>
+		void copySection(std::vector<T>& target, const std::string_view bytes, const size_t offset, const size_t count)
+		{
+			target.resize(count);
+			if (count > 0)
+				std::memcpy(target.data(), bytes.data() + offset, count * sizeof(T));
+		}
+
+		std::unexpected<LoadError> damaged(const std::string& message)
+		{
+			return std::unexpected(LoadError { .kind = LoadError::Kind::Format, .line = 0, .column = 0, .message = message });
+		}
+
+		// the checks of loadProgram() on already decoded instructions; empty if the code is valid
+		std::string checkCode(const std::vector<Instruction>& code)
+		{
+			for (size_t i = 0; i < code.size(); i++)
+			{
+				const Instruction& ins = code[i];
+				switch (ins.op)
+				{
+				case Op::READ: case Op::WRITE: case Op::RTRN: case Op::HALT:
+				case Op::LOAD: case Op::STORE:
+					break;
+				case Op::JUMP: case Op::JPOS: case Op::JZERO: case Op::CALL:
+					if (ins.arg >= code.size())
+						return std::format("instruction {}: jump target {} out of range", i, ins.arg);
+					break;
+				case Op::RLOAD: case Op::RSTORE: case Op::ADD: case Op::SUB: case Op::SWP:
+				case Op::RST: case Op::INC: case Op::DEC: case Op::SHL: case Op::SHR:
+					if (ins.reg >= 8)
+						return std::format("instruction {}: register {} does not exist", i, ins.reg);
+					break;
+				default:
+					return std::format("instruction {}: unknown opcode {}", i, static_cast<int>(ins.op));
+				}
+			}
+			return {};
+		}
+
+		// what the engines and fuse() rely on, without repeating the analysis: the blocks tile the code in order
+		// and cost what their instructions do, and every entry cost follows from the next one as in buildBlocks(). Where the blocks are split only
+		// decides what fuse() may merge, and fused instructions keep the originals behind them for jumps.
+		std::string checkBlocks(const Program& program)
+		{
+			const auto& code = program.code;
+			const auto& blocks = program.blocks;
+
+			uint32_t next = 0;
+			for (size_t i = 0; i < blocks.size(); i++)
+			{
+				const BasicBlock& block = blocks[i];
+				if (block.start != next || block.end <= block.start || block.end > code.size())
+					return std::format("block {} [{}, {}) does not follow the previous one", i, block.start, block.end);
+
+				var_t cost = 0;
+				for (uint32_t pc = block.start; pc < block.end; pc++)
+					cost += instructionCost(code[pc].op);
+				if (cost != block.cost)
+					return std::format("block {} costs {}, its instructions {}", i, block.cost, cost);
+				next = block.end;
+			}
+			if (next != code.size())
+				return std::format("the blocks cover {} of {} instructions", next, code.size());
+
+			if (program.entry_cost[code.size()] != 0)
+				return "the block costs do not end with 0";
+			for (size_t pc = 0; pc < code.size(); pc++)
+			{
+				const Op op = code[pc].op;
+				if (program.entry_cost[pc] != instructionCost(op) + (isControl(op) ? 0 : program.entry_cost[pc + 1]))
+					return std::format("instruction {}: block cost {} does not match the code", pc, program.entry_cost[pc]);
+			}
+			return {};
+		}
+	}
+
+
+	bool isImage(const std::string_view bytes)
+	{
+		uint32_t magic = 0;
+		if (bytes.size() < sizeof(magic))
+			return false;
+		std::memcpy(&magic, bytes.data(), sizeof(magic));
+		return magic == image_magic;
+	}
+
+	bool isImageFile(const std::filesystem::path& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		char head[sizeof(image_magic)] = {};
+		file.read(head, sizeof(head));
+		return file && isImage(std::string_view(head, sizeof(head)));
+	}
+
+	std::string writeImage(const Program& program, const std::vector<int>& lines)
+	{
+		if (!program.constants.empty() || !checkCode(program.code).empty())
+			throw std::invalid_argument("only a decoded, unfused program can be written as an image");
+		if (!lines.empty() && lines.size() != program.code.size())
+			throw std::invalid_argument(std::format("{} source lines for {} instructions", lines.size(), program.code.size()));
+		if (program.entry_cost.size() != program.code.size() + 1)
+			throw std::invalid_argument("the program has no blocks, see buildBlocks()");
+
+		const ImageHeader header {
+			.magic = image_magic,
+			.version = image_version,
+			.word_size = sizeof(var_t),
+			.flags = lines.empty() ? 0 : image_has_lines,
+			.instruction_count = static_cast<uint32_t>(program.code.size()),
+			.block_count = static_cast<uint32_t>(program.blocks.size()),
+			.reserved = 0,
+		};
+		const Layout layout(program.code.size(), program.blocks.size(), !lines.empty());
+
+		// zero-filled, so the padding is deterministic
+		std::string bytes(layout.end, '\0');
+		std::memcpy(bytes.data(), &header, sizeof(header));
+		std::memcpy(bytes.data() + layout.code, program.code.data(), program.code.size() * sizeof(Instruction));
+		std::memcpy(bytes.data() + layout.blocks, program.blocks.data(), program.blocks.size() * sizeof(BasicBlock));
+		std::memcpy(bytes.data() + layout.entry_cost, program.entry_cost.data(), program.entry_cost.size() * sizeof(var_t));
+
+		for (size_t i = 0; i < lines.size(); i++)
+		{
+			const int32_t line = lines[i];
+			std::memcpy(bytes.data() + layout.lines + i * sizeof(int32_t), &line, sizeof(line));
+		}
+
+		return bytes;
+	}
+
+	std::expected<void, LoadError> saveImage(const std::filesystem::path& path, const Program& program, const std::vector<int>& lines)
+	{
+		const std::string bytes = writeImage(program, lines);
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file || !file.write(bytes.data(), bytes.size()))
+			return std::unexpected(LoadError { .kind = LoadError::Kind::Io, .line = 0, .column = 0, .message = std::format("could not write '{}'", path.string()) });
+		return {};
+	}
+
+	std::expected<Program, LoadError> readImage(const std::string_view bytes, std::vector<int>* lines)
+	{
+		ImageHeader header;
+		if (bytes.size() < sizeof(header) || !isImage(bytes))
+			return damaged("not a binary program image");
+		std::memcpy(&header, bytes.data(), sizeof(header));
+
+		if (header.version != image_version)
+			return damaged(std::format("image version {}, expected {}; convert the .mr file again", header.version, image_version));
+		if (header.word_size != sizeof(var_t) || (header.flags & ~image_has_lines) != 0)
+			return damaged("the image was written by an incompatible build");
+
+		const bool has_lines = header.flags & image_has_lines;
+		const Layout layout(header.instruction_count, header.block_count, has_lines);
+		if (bytes.size() != layout.end)
+			return damaged(std::format("the image is {} bytes, its header describes {}", bytes.size(), layout.end));
+
+		// the mapping does not outlive loadProgram(), so the code is copied into the Program
+		Program program;
+		copySection(program.code, bytes, layout.code, header.instruction_count);
+		if (const std::string error = checkCode(program.code); !error.empty())
+			return damaged(error);
+
+		// the sizes are fixed by the layout checked above
+		copySection(program.blocks, bytes, layout.blocks, header.block_count);
+		copySection(program.entry_cost, bytes, layout.entry_cost, header.instruction_count + size_t(1));
+		if (const std::string error = checkBlocks(program); !error.empty())
+			return damaged(error);
+
+		if (lines)
+		{
+			lines->clear();
+			if (has_lines)
+			{
+				std::vector<int32_t> stored;
+				copySection(stored, bytes, layout.lines, header.instruction_count);
+				lines->assign(stored.begin(), stored.end());
+			}
+		}
+
+		return program;
+	}
+
+} // namespace vm
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "program.hpp"
+#include "loader.hpp"
+
+
+namespace vm
+{
+
+/**
+ * Binary program image (.mrb): a decoded, unfused Program that is loaded with one copy and no parsing.
+ *
+ * Layout, in host byte order (checked through `magic`), every section 8-byte aligned:
+ *	ImageHeader
+ *	Instruction	code[instruction_count]
+ *	BasicBlock	blocks[block_count]
+ *	var_t		entry_cost[instruction_count + 1]
+ *	int32_t		lines[instruction_count]			only with image_has_lines, padded to 8 bytes
+ */
+struct ImageHeader
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t word_size;			// sizeof(var_t)
+	uint32_t flags;
+	uint32_t instruction_count;
+	uint32_t block_count;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(ImageHeader) == 24, "vm::ImageHeader is part of the file format");
+static_assert(sizeof(BasicBlock) == 16, "vm::BasicBlock is part of the file format");
+
+// "\x7fMRB" read as a little-endian integer; no .mr text starts with 0x7f
+constexpr uint32_t image_magic = 0x42524d7f;
+// bumped whenever the layout or the meaning of Instruction changes
+constexpr uint16_t image_version = 1;
+
+constexpr uint32_t image_has_lines = 1 << 0;
+
+
+// true if `bytes` starts with the image magic, whatever its version
+bool isImage(std::string_view bytes);
+
+// the same for the first bytes of a file; false if it cannot be read
+bool isImageFile(const std::filesystem::path& path);
+
+// Serializes a program from decode() or loadProgram(); `lines` may be empty. Throws std::invalid_argument for a fused program.
+std::string writeImage(const Program& program, const std::vector<int>& lines = {});
+
+// writeImage() into a file
+std::expected<void, LoadError> saveImage(const std::filesystem::path& path, const Program& program, const std::vector<int>& lines = {});
+
+/**
+ * @brief Reads an image written by writeImage().
+ *
+ * @details
+ * All sections are copied as they are. The operands, the block ranges and costs and the entry costs
+ * are checked against the code in linear passes, without repeating the analysis of buildBlocks(),
+ * so a damaged or foreign file is rejected instead of crashing an engine or charging a wrong cost.
+ * loadProgram() calls this for any file that starts with the image magic.
+ * @param lines	if given, receives the source lines, or is cleared if the image has none
+ */
+std::expected<Program, LoadError> readImage(std::string_view bytes, std::vector<int>* lines = nullptr);
+
+} // namespace vm
@@ -0,0 +1,471 @@
+#include "jit.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <cstring>
+#include <format>
+#include <limits>
+
+#include "memory.hpp"
+
+#if defined(__x86_64__) && defined(__linux__)
+#include <sys/mman.h>
+#define FLTT_JIT_AVAILABLE 1
+#endif
+
+
+namespace vm
+{
+
+#if defined(FLTT_JIT_AVAILABLE)
+
+	namespace
+	{
+		// state shared between the native code and the callouts; offsets are baked into the generated code
+		struct Context
+		{
+			std::array<var_t, 8> r;
+			var_t t;
+			var_t io;
+			var_t pc;	// faulting instruction for ExitCode::BadJump
+			PagedMemory* memory;
+			const std::vector<var_t>* cin;
+			size_t cin_counter;
+			std::vector<var_t>* output;
+		};
+
+		enum ExitCode : uint32_t { Halt, InputExhausted, BadJump };
+
+		struct ReadResult
+		{
+			var_t value;
+			uint64_t ok;
+		};
+
+		var_t calloutLoad(PagedMemory* memory, const var_t address) { return memory->load(address); }
+		void calloutStore(PagedMemory* memory, const var_t address, const var_t value) { memory->store(address, value); }
+
+		ReadResult calloutRead(Context* ctx)
+		{
+			if (ctx->cin_counter >= ctx->cin->size())
+				return ReadResult { 0, 0 };
+			ctx->io += 100;
+			return ReadResult { (*ctx->cin)[ctx->cin_counter++], 1 };
+		}
+
+		void calloutWrite(Context* ctx, const var_t value)
+		{
+			ctx->output->push_back(value);
+			ctx->io += 100;
+		}
+	}
+
+
+	namespace
+	{
+		// host registers
+		enum Reg : uint8_t { RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7, R8 = 8, R9 = 9, R10 = 10, R11 = 11, R12 = 12, R13 = 13, R14 = 14, R15 = 15 };
+
+		// VM register -> host register; r0 stays in rbx so RTRN can index tables with it
+		constexpr std::array<uint8_t, 8> vm_reg = { RBX, RBP, R12, R13, R14, R15, R10, R11 };
+		constexpr uint8_t CTX = R8;		// Context*
+		constexpr uint8_t COST = R9;	// `t`
+
+		enum Cond : uint8_t { CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_LE = 0xE };
+
+		class Assembler
+		{
+		public:
+
+			std::vector<uint8_t> code;
+
+			size_t size() const { return code.size(); }
+
+			void byte(const uint8_t b) { code.push_back(b); }
+			void dword(const uint32_t v) { for (int i = 0; i < 4; i++) byte(static_cast<uint8_t>(v >> (8 * i))); }
+			void qword(const uint64_t v) { for (int i = 0; i < 8; i++) byte(static_cast<uint8_t>(v >> (8 * i))); }
+
+			void rex(const uint8_t reg, const uint8_t rm)
+			{
+				byte(0x48 | ((reg >> 3) << 2) | (rm >> 3));
+			}
+
+			// <op> rm, reg  (mov 0x89, add 0x01, sub 0x29, cmp 0x39, xor 0x31, test 0x85, xchg 0x87)
+			void rr(const uint8_t opcode, const uint8_t rm, const uint8_t reg)
+			{
+				rex(reg, rm);
+				byte(opcode);
+				byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+			}
+
+			void mov(const uint8_t dst, const uint8_t src) { rr(0x89, dst, src); }
+
+			void movImm(const uint8_t dst, const var_t value)
+			{
+				if (value >= std::numeric_limits<int32_t>::min() && value <= std::numeric_limits<int32_t>::max())
+				{
+					rex(0, dst);
+					byte(0xC7);
+					byte(0xC0 | (dst & 7));
+					dword(static_cast<uint32_t>(value));
+				}
+				else
+				{
+					rex(0, dst);
+					byte(0xB8 | (dst & 7));
+					qword(static_cast<uint64_t>(value));
+				}
+			}
+
+			// 0x81 group with a sign-extended imm32: /0 add, /5 sub, /7 cmp
+			void groupImm(const uint8_t ext, const uint8_t dst, const int32_t value)
+			{
+				rex(0, dst);
+				byte(0x81);
+				byte(0xC0 | (ext << 3) | (dst & 7));
+				dword(static_cast<uint32_t>(value));
+			}
+
+			void addCost(const var_t cost)
+			{
+				if (cost == 0)
+					return;
+				if (cost <= std::numeric_limits<int32_t>::max())
+				{
+					groupImm(0, COST, static_cast<int32_t>(cost));
+				}
+				else
+				{
+					movImm(RAX, cost);
+					rr(0x01, COST, RAX);
+				}
+			}
+
+			// single-operand groups: inc FF /0, dec FF /1, shl-by-1 D1 /4, sar-by-1 D1 /7
+			void unary(const uint8_t opcode, const uint8_t ext, const uint8_t reg)
+			{
+				rex(0, reg);
+				byte(opcode);
+				byte(0xC0 | (ext << 3) | (reg & 7));
+			}
+
+			void cmovl(const uint8_t dst, const uint8_t src)
+			{
+				rex(dst, src);
+				byte(0x0F);
+				byte(0x4C);
+				byte(0xC0 | ((dst & 7) << 3) | (src & 7));
+			}
+
+			// mov reg, [base + disp32] / mov [base + disp32], reg; base must not be rsp/r12
+			void load(const uint8_t reg, const uint8_t base, const int32_t disp)
+			{
+				rex(reg, base);
+				byte(0x8B);
+				byte(0x80 | ((reg & 7) << 3) | (base & 7));
+				dword(static_cast<uint32_t>(disp));
+			}
+
+			void store(const uint8_t base, const int32_t disp, const uint8_t reg)
+			{
+				rex(reg, base);
+				byte(0x89);
+				byte(0x80 | ((reg & 7) << 3) | (base & 7));
+				dword(static_cast<uint32_t>(disp));
+			}
+
+			void push(const uint8_t reg) { if (reg >= 8) byte(0x41); byte(0x50 | (reg & 7)); }
+			void pop(const uint8_t reg) { if (reg >= 8) byte(0x41); byte(0x58 | (reg & 7)); }
+
+			void call(const void* function)
+			{
+				movImm(RAX, static_cast<var_t>(reinterpret_cast<uintptr_t>(function)));
+				byte(0xFF);
+				byte(0xD0);	// call rax
+			}
+
+			// returns the offset of the rel32 field
+			size_t jcc(const Cond cond)
+			{
+				byte(0x0F);
+				byte(0x80 | cond);
+				dword(0);
+				return size() - 4;
+			}
+
+			size_t jmp()
+			{
+				byte(0xE9);
+				dword(0);
+				return size() - 4;
+			}
+
+			void patch(const size_t at, const size_t target)
+			{
+				const int32_t rel = static_cast<int32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(at + 4));
+				std::memcpy(&code[at], &rel, 4);
+			}
+		};
+
+		// caller-saved registers that carry VM or JIT state across callouts (4 pushes keep rsp 16-byte aligned)
+		constexpr std::array<uint8_t, 4> saved = { R8, R9, R10, R11 };
+	}
+
+	JitProgram::~JitProgram()
+	{
+		if (m_code)
+			munmap(m_code, m_code_size);
+	}
+
+	std::unique_ptr<JitProgram> JitProgram::compile(const Program& program)
+	{
+		const auto& code = program.code;
+		const size_t size = code.size();
+		if (size == 0 || size >= static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+			return nullptr;
+
+		std::unique_ptr<JitProgram> jit(new JitProgram());
+		jit->m_program_size = size;
+		jit->m_entry_cost = program.entry_cost;
+		jit->m_targets.assign(size, 0);
+
+		Assembler as;
+		std::vector<size_t> label(size + 1);
+		std::vector<std::pair<size_t, uint32_t>> fixups;	// rel32 offset -> instruction
+		std::vector<size_t> to_bad_jump, to_input_exhausted, to_halt;
+
+		auto jumpTo = [&](const uint32_t target) {
+			as.addCost(program.entry_cost[target]);
+			fixups.emplace_back(as.jmp(), target);
+		};
+		// r0 <cond> -> target, otherwise continue at `fallthrough`
+		auto branch = [&](const Cond not_taken, const uint32_t target, const uint32_t fallthrough, const bool adjacent) {
+			as.rr(0x85, RBX, RBX);	// test rbx, rbx
+			const size_t skip = as.jcc(not_taken);
+			jumpTo(target);
+			as.patch(skip, as.size());
+			if (adjacent)
+				as.addCost(program.entry_cost[fallthrough]);
+			else
+				jumpTo(fallthrough);
+		};
+		auto callout = [&](const void* function, auto&& set_arguments) {
+			for (const uint8_t reg : saved)
+				as.push(reg);
+			set_arguments();
+			as.call(function);
+			for (auto it = saved.rbegin(); it != saved.rend(); ++it)
+				as.pop(*it);
+		};
+		auto memoryLoad = [&](auto&& set_address) {
+			callout(reinterpret_cast<const void*>(&calloutLoad), [&] {
+				as.load(RDI, CTX, offsetof(Context, memory));
+				set_address();
+			});
+			as.mov(RBX, RAX);
+		};
+		auto memoryStore = [&](auto&& set_address) {
+			callout(reinterpret_cast<const void*>(&calloutStore), [&] {
+				as.load(RDI, CTX, offsetof(Context, memory));
+				set_address();
+				as.mov(RDX, RBX);
+			});
+		};
+		auto sub = [&](const uint8_t x) {
+			as.mov(RAX, RBX);
+			as.rr(0x29, RAX, vm_reg[x]);	// sub rax, rx
+			as.rr(0x31, RCX, RCX);			// xor rcx, rcx
+			as.rr(0x39, RBX, vm_reg[x]);	// cmp r0, rx
+			as.cmovl(RAX, RCX);
+			as.mov(RBX, RAX);
+		};
+
+		// prologue: save callee-saved registers, align the stack, load VM state from the context
+		for (const uint8_t reg : { RBX, RBP, R12, R13, R14, R15 })
+			as.push(reg);
+		as.groupImm(5, RSP, 8);
+		as.mov(CTX, RDI);
+		for (size_t i = 0; i < 8; i++)
+			as.load(vm_reg[i], CTX, static_cast<int32_t>(offsetof(Context, r) + 8 * i));
+		as.load(COST, CTX, offsetof(Context, t));
+
+		for (uint32_t pc = 0; pc < size; pc++)
+		{
+			label[pc] = as.size();
+			const Instruction ins = code[pc];
+			const uint8_t x = vm_reg[ins.reg];
+
+			switch (ins.op)
+			{
+			case Op::READ:
+				callout(reinterpret_cast<const void*>(&calloutRead), [&] { as.mov(RDI, CTX); });
+				as.rr(0x85, RDX, RDX);
+				to_input_exhausted.push_back(as.jcc(CC_E));
+				as.mov(RBX, RAX);
+				break;
+			case Op::WRITE:
+				callout(reinterpret_cast<const void*>(&calloutWrite), [&] { as.mov(RDI, CTX); as.mov(RSI, RBX); });
+				break;
+
+			case Op::LOAD:		memoryLoad([&] { as.movImm(RSI, ins.arg); }); break;
+			case Op::STORE:		memoryStore([&] { as.movImm(RSI, ins.arg); }); break;
+			case Op::RLOAD:		memoryLoad([&] { as.mov(RSI, x); }); break;
+			case Op::RSTORE:	memoryStore([&] { as.mov(RSI, x); }); break;
+
+			case Op::ADD:	as.rr(0x01, RBX, x); break;
+			case Op::SUB:	sub(ins.reg); break;
+			case Op::SWP:	as.rr(0x87, RBX, x); break;
+
+			case Op::RST:	as.rr(0x31, x, x); break;
+			case Op::INC:	as.unary(0xFF, 0, x); break;
+			case Op::DEC:
+				as.byte(0x31); as.byte(0xC0);					// xor eax, eax
+				as.rr(0x85, x, x);								// test rx, rx
+				as.byte(0x0F); as.byte(0x9F); as.byte(0xC0);	// setg al
+				as.rr(0x29, x, RAX);							// sub rx, rax
+				break;
+			case Op::SHL:	as.unary(0xD1, 4, x); break;
+			case Op::SHR:	as.unary(0xD1, 7, x); break;
+
+			case Op::JUMP:	jumpTo(ins.arg); break;
+			case Op::JPOS:	branch(CC_LE, ins.arg, pc + 1, true); break;
+			case Op::JZERO:	branch(CC_NE, ins.arg, pc + 1, true); break;
+
+			case Op::CALL:
+				as.movImm(RBX, pc + 1);
+				jumpTo(ins.arg);
+				break;
+			case Op::RTRN:
+				as.groupImm(7, RBX, static_cast<int32_t>(size));	// cmp rbx, size
+				to_bad_jump.push_back(as.jcc(CC_AE));				// unsigned: also catches negative targets
+				as.movImm(RDX, static_cast<var_t>(reinterpret_cast<uintptr_t>(jit->m_entry_cost.data())));
+				as.byte(0x4C); as.byte(0x03); as.byte(0x0C); as.byte(0xDA);	// add r9, [rdx + rbx*8]
+				as.movImm(RCX, static_cast<var_t>(reinterpret_cast<uintptr_t>(jit->m_targets.data())));
+				as.byte(0xFF); as.byte(0x24); as.byte(0xD9);				// jmp [rcx + rbx*8]
+				break;
+
+			case Op::HALT:
+				to_halt.push_back(as.jmp());
+				break;
+
+			case Op::SET:
+				as.movImm(x, program.constants[ins.arg]);
+				fixups.emplace_back(as.jmp(), pc + ins.aux);
+				break;
+			case Op::LOAD_SWP:
+				memoryLoad([&] { as.movImm(RSI, ins.arg); });
+				as.rr(0x87, RBX, x);
+				fixups.emplace_back(as.jmp(), pc + 2);
+				break;
+			case Op::SUB_JZERO:
+				sub(ins.reg);
+				branch(CC_NE, ins.arg, pc + 2, false);
+				break;
+			case Op::SUB_JPOS:
+				sub(ins.reg);
+				branch(CC_LE, ins.arg, pc + 2, false);
+				break;
+			}
+		}
+
+		// running off the end of the program
+		label[size] = as.size();
+		as.movImm(RBX, static_cast<var_t>(size));
+		const size_t bad_jump = as.size();
+		as.store(CTX, offsetof(Context, pc), RBX);
+		as.byte(0xB8); as.dword(BadJump);	// mov eax, BadJump
+		const size_t to_epilogue_bad = as.jmp();
+
+		const size_t input_exhausted = as.size();
+		as.byte(0xB8); as.dword(InputExhausted);
+		const size_t to_epilogue_input = as.jmp();
+
+		const size_t halt = as.size();
+		as.byte(0xB8); as.dword(Halt);
+
+		// epilogue: hand the VM state back and restore callee-saved registers
+		const size_t epilogue = as.size();
+		as.store(CTX, offsetof(Context, t), COST);
+		for (size_t i = 0; i < 8; i++)
+			as.store(CTX, static_cast<int32_t>(offsetof(Context, r) + 8 * i), vm_reg[i]);
+		as.groupImm(0, RSP, 8);
+		for (const uint8_t reg : { R15, R14, R13, R12, RBP, RBX })
+			as.pop(reg);
+		as.byte(0xC3);	// ret
+
+		for (const auto& [at, target] : fixups)
+			as.patch(at, label[target]);
+		for (const size_t at : to_bad_jump)
+			as.patch(at, bad_jump);
+		for (const size_t at : to_input_exhausted)
+			as.patch(at, input_exhausted);
+		for (const size_t at : to_halt)
+			as.patch(at, halt);
+		as.patch(to_epilogue_bad, epilogue);
+		as.patch(to_epilogue_input, epilogue);
+
+		void* buffer = mmap(nullptr, as.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (buffer == MAP_FAILED)
+			return nullptr;
+		std::memcpy(buffer, as.code.data(), as.size());
+		if (mprotect(buffer, as.size(), PROT_READ | PROT_EXEC) != 0)
+		{
+			munmap(buffer, as.size());
+			return nullptr;
+		}
+
+		jit->m_code = static_cast<uint8_t*>(buffer);
+		jit->m_code_size = as.size();
+		for (size_t pc = 0; pc < size; pc++)
+			jit->m_targets[pc] = reinterpret_cast<uintptr_t>(jit->m_code + label[pc]);
+
+		return jit;
+	}
+
+	var_t JitProgram::run(const std::vector<var_t>& cin, std::vector<var_t>& output) const
+	{
+		PagedMemory pam;
+
+		Context ctx {};
+		ctx.memory = &pam;
+		ctx.cin = &cin;
+		ctx.output = &output;
+		ctx.t = m_entry_cost[0];
+
+		std::srand(std::time(0));
+		for (int i = 0; i < 8; i++)
+			ctx.r[i] = rand();
+
+		using Entry = uint32_t (*)(Context*);
+		const uint32_t exit_code = reinterpret_cast<Entry>(m_code)(&ctx);
+
+		switch (exit_code)
+		{
+		case InputExhausted:
+			return -1;
+		case BadJump:
+			throw RuntimeError(std::format("instruction {} does not exist", ctx.pc));
+		default:
+			return ctx.t + ctx.io;
+		}
+	}
+
+#else
+
+	JitProgram::~JitProgram() = default;
+
+	std::unique_ptr<JitProgram> JitProgram::compile(const Program&)
+	{
+		return nullptr;
+	}
+
+	var_t JitProgram::run(const std::vector<var_t>&, std::vector<var_t>&) const
+	{
+		return -1;
+	}
+
+#endif
+
+} // namespace vm
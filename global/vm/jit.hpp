@@ -0,0 +1,56 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+#include "program.hpp"
+
+
+namespace vm
+{
+
+/**
+ * @brief Native x86-64 translation of a decoded program.
+ *
+ * @details
+ * Every instruction becomes a short native sequence in an mmap'd executable buffer.
+ * The eight VM registers live in host registers, LOAD/STORE/RLOAD/RSTORE and READ/WRITE
+ * call out to PagedMemory and the input/output vectors, and cost is charged on every
+ * control transfer from Program::entry_cost, exactly like the interpreters.
+ * Superinstructions are supported, so fused programs can be compiled too.
+ */
+class JitProgram
+{
+private:
+
+	uint8_t* m_code = nullptr;
+	size_t m_code_size = 0;
+	std::vector<uintptr_t> m_targets;	// native address of every instruction, for RTRN
+	std::vector<var_t> m_entry_cost;
+	size_t m_program_size = 0;
+
+	JitProgram() = default;
+
+public:
+
+	JitProgram(const JitProgram&) = delete;
+	JitProgram& operator=(const JitProgram&) = delete;
+	~JitProgram();
+
+	/**
+	 * @brief Translates the program to native code.
+	 *
+	 * @return nullptr if the JIT is not available on this platform or the program cannot be translated;
+	 * callers are expected to fall back to an interpreter
+	 */
+	static std::unique_ptr<JitProgram> compile(const Program& program);
+
+	/**
+	 * @brief Runs the program. Same contract as the interpreters: returns the total cost,
+	 * -1 if the program reads past the end of `cin`, and throws vm::RuntimeError on a jump to a nonexistent instruction.
+	 */
+	var_t run(const std::vector<var_t>& cin, std::vector<var_t>& output) const;
+};
+
+} // namespace vm
@@ -0,0 +1,452 @@
+#include "loader.hpp"
+#include "image.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace vm
+{
+
+	namespace
+	{
+		// read-only private mapping of a whole file, unmapped on destruction
+		class MappedFile
+		{
+		public:
+
+			static std::expected<MappedFile, LoadError> open(const std::filesystem::path& path)
+			{
+				auto failure = [&](const std::string_view what) {
+					return std::unexpected(LoadError { .kind = LoadError::Kind::Io, .line = 0, .column = 0, .message = std::format("could not {} '{}'", what, path.string()) });
+				};
+
+				const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+				if (fd < 0)
+					return failure("open");
+
+				struct stat status;
+				if (::fstat(fd, &status) != 0)
+				{
+					::close(fd);
+					return failure("read");
+				}
+
+				MappedFile file;
+				file.m_size = static_cast<size_t>(status.st_size);
+				// mmap() rejects empty mappings, and an empty file is just an empty program
+				if (file.m_size > 0)
+				{
+					void* data = ::mmap(nullptr, file.m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if (data == MAP_FAILED)
+					{
+						::close(fd);
+						return failure("map");
+					}
+					::madvise(data, file.m_size, MADV_SEQUENTIAL);
+					file.m_data = static_cast<const char*>(data);
+				}
+				::close(fd);
+				return file;
+			}
+
+			MappedFile(MappedFile&& other) noexcept
+				: m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0))
+			{
+			}
+
+			MappedFile& operator=(MappedFile&&) = delete;
+
+			~MappedFile()
+			{
+				if (m_data)
+					::munmap(const_cast<char*>(m_data), m_size);
+			}
+
+			std::string_view view() const
+			{
+				return m_data ? std::string_view(m_data, m_size) : std::string_view();
+			}
+
+		private:
+
+			MappedFile() = default;
+
+			const char* m_data = nullptr;
+			size_t m_size = 0;
+		};
+
+
+		enum class Operand
+		{
+			None,				// READ, WRITE, RTRN, HALT
+			RegisterOrNumber,	// COM_1 of the grammar
+			Number,				// jumps
+		};
+
+		struct Mnemonic
+		{
+			Op op;
+			Operand operand;
+		};
+
+		// the mnemonics of the language, superinstructions excluded
+		constexpr auto names = std::span(op_names).first<static_cast<size_t>(Op::HALT) + 1>();
+
+		constexpr Operand operandOf(const Op op)
+		{
+			switch (op)
+			{
+			case Op::READ: case Op::WRITE: case Op::RTRN: case Op::HALT:
+				return Operand::None;
+			case Op::JUMP: case Op::JPOS: case Op::JZERO: case Op::CALL:
+				return Operand::Number;
+			default:
+				return Operand::RegisterOrNumber;
+			}
+		}
+
+		// up to 8 characters in one integer
+		constexpr uint64_t pack(const std::string_view word)
+		{
+			uint64_t key = 0;
+			for (const char c : word)
+				key = key << 8 | static_cast<uint8_t>(c);
+			return key;
+		}
+
+		// perfect hash of the 20 packed mnemonics into 32 slots, so a word is looked up with one
+		// multiplication and one comparison instead of a chain of mispredicted branches
+		constexpr uint64_t hash_multiplier = 0x662d3fee77199f07;
+
+		constexpr size_t slotOf(const uint64_t key)
+		{
+			return static_cast<size_t>((key * hash_multiplier) >> 59);
+		}
+
+		struct Slot
+		{
+			uint64_t key = 0;		// 0: empty
+			Mnemonic mnemonic {};
+		};
+
+		constexpr std::array<Slot, 32> makeMnemonicTable()
+		{
+			std::array<Slot, 32> table {};
+			for (size_t i = 0; i < std::size(names); i++)
+			{
+				const Op op = static_cast<Op>(i);
+				table[slotOf(pack(names[i]))] = Slot { .key = pack(names[i]), .mnemonic = Mnemonic { op, operandOf(op) } };
+			}
+			return table;
+		}
+
+		constexpr std::array<Slot, 32> mnemonic_table = makeMnemonicTable();
+
+		static_assert([] {
+			for (const auto name : names)
+			{
+				if (mnemonic_table[slotOf(pack(name))].key != pack(name))
+					return false;
+			}
+			return true;
+		}(), "two mnemonics share a slot, hash_multiplier has to be changed");
+
+		std::optional<Mnemonic> mnemonic(const std::string_view word)
+		{
+			if (word.size() > 6)
+				return std::nullopt;
+			const uint64_t key = pack(word);
+			const Slot& slot = mnemonic_table[slotOf(key)];
+			if (slot.key != key)
+				return std::nullopt;
+			return slot.mnemonic;
+		}
+
+
+		struct Token
+		{
+			enum class Kind
+			{
+				End,
+				Mnemonic,
+				Register,
+				Number,
+				Invalid,	// see Scanner::error()
+			};
+
+			Kind kind;
+			int line;
+			int column;
+			std::string_view text {};
+			Mnemonic mnemonic {};
+			var_t value = 0;		// register index or number
+		};
+
+		LoadError error(const LoadError::Kind kind, const Token& token, std::string message)
+		{
+			return LoadError { .kind = kind, .line = token.line, .column = token.column, .message = std::move(message) };
+		}
+
+		class Scanner
+		{
+		public:
+
+			explicit Scanner(const std::string_view source)
+				: m_p(source.data()), m_end(source.data() + source.size()), m_line_start(m_p)
+			{
+			}
+
+			// the next token; errors are rare, so they are returned as an Invalid token and kept aside
+			Token next()
+			{
+				skip();
+				Token token { .kind = Token::Kind::End, .line = m_line, .column = column(m_p) };
+				if (m_p == m_end)
+					return token;
+
+				const char* start = m_p;
+				if (isLetter(*m_p))
+				{
+					while (m_p != m_end && isLetter(*m_p))
+						m_p++;
+					token.text = std::string_view(start, m_p);
+
+					if (token.text.size() == 1 && token.text[0] >= 'a' && token.text[0] <= 'h')
+					{
+						token.kind = Token::Kind::Register;
+						token.value = token.text[0] - 'a';
+						return token;
+					}
+					if (const auto found = mnemonic(token.text))
+					{
+						token.kind = Token::Kind::Mnemonic;
+						token.mnemonic = *found;
+						return token;
+					}
+					return invalid(token, LoadError::Kind::Symbol, "unknown symbol");
+				}
+
+				if (isDigit(*m_p))
+				{
+					uint64_t value = 0;
+					bool overflow = false;
+					while (m_p != m_end && isDigit(*m_p))
+					{
+						const uint64_t digit = static_cast<uint64_t>(*m_p - '0');
+						overflow |= value > (static_cast<uint64_t>(std::numeric_limits<var_t>::max()) - digit) / 10;
+						value = value * 10 + digit;
+						m_p++;
+					}
+					token.text = std::string_view(start, m_p);
+					if (overflow)
+						return invalid(token, LoadError::Kind::Operand, "number too large");
+					token.kind = Token::Kind::Number;
+					token.value = static_cast<var_t>(value);
+					return token;
+				}
+
+				token.text = std::string_view(start, 1);
+				return invalid(token, LoadError::Kind::Symbol, "unexpected character");
+			}
+
+			// why the last token was Invalid
+			const LoadError& error() const
+			{
+				return m_error;
+			}
+
+		private:
+
+			static bool isLetter(const char c)
+			{
+				return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+			}
+
+			static bool isDigit(const char c)
+			{
+				return c >= '0' && c <= '9';
+			}
+
+			int column(const char* p) const
+			{
+				return static_cast<int>(p - m_line_start) + 1;
+			}
+
+			// whitespace, line breaks and comments
+			void skip()
+			{
+				while (m_p != m_end)
+				{
+					switch (*m_p)
+					{
+					case ' ':
+					case '\t':
+					case '\r':
+						m_p++;
+						break;
+					case '\n':
+						m_p++;
+						m_line++;
+						m_line_start = m_p;
+						break;
+					case '#':
+						m_p = std::find(m_p, m_end, '\n');
+						break;
+					default:
+						return;
+					}
+				}
+			}
+
+			Token invalid(Token token, const LoadError::Kind kind, const std::string_view what)
+			{
+				m_error = vm::error(kind, token, std::format("{} '{}'", what, token.text));
+				token.kind = Token::Kind::Invalid;
+				return token;
+			}
+
+			const char* m_p;
+			const char* const m_end;
+			const char* m_line_start;
+			int m_line = 1;
+			LoadError m_error {};
+		};
+
+		std::string describe(const Token& token)
+		{
+			switch (token.kind)
+			{
+			case Token::Kind::End:		return "end of file";
+			case Token::Kind::Mnemonic:	return std::format("instruction {}", token.text);
+			case Token::Kind::Register:	return std::format("register {}", token.text);
+			case Token::Kind::Number:	return std::format("number {}", token.text);
+			case Token::Kind::Invalid:	return std::format("'{}'", token.text);
+			}
+			return "";
+		}
+	}
+
+
+	std::string LoadError::describe() const
+	{
+		if (line == 0)
+			return message;
+		return std::format("line {}:{}: {}", line, column, message);
+	}
+
+	std::expected<Program, LoadError> parseProgram(const std::string_view source, std::vector<int>* lines)
+	{
+		// the lines are needed for jump error messages even if the caller does not want them
+		std::vector<int> own_lines;
+		std::vector<int>& line_of = lines ? *lines : own_lines;
+		line_of.clear();
+
+		Program program;
+		// "INC a\n" is the shortest common line
+		program.code.reserve(source.size() / 6 + 1);
+		line_of.reserve(source.size() / 6 + 1);
+
+		std::vector<JumpError> jump_errors;
+
+		Scanner scanner(source);
+		while (true)
+		{
+			const Token token = scanner.next();
+			if (token.kind == Token::Kind::Invalid)
+				return std::unexpected(scanner.error());
+			if (token.kind == Token::Kind::End)
+				break;
+			if (token.kind != Token::Kind::Mnemonic)
+				return std::unexpected(error(LoadError::Kind::Syntax, token, std::format("expected an instruction, found {}", describe(token))));
+
+			const Mnemonic mnemonic = token.mnemonic;
+			const std::string_view name = names[static_cast<int>(mnemonic.op)];
+			Instruction ins { .op = mnemonic.op, .reg = 0, .aux = 0, .arg = 0 };
+			int line = token.line;
+
+			if (mnemonic.operand != Operand::None)
+			{
+				const Token operand = scanner.next();
+				if (operand.kind == Token::Kind::Invalid)
+					return std::unexpected(scanner.error());
+
+				const bool number = operand.kind == Token::Kind::Number;
+				const bool accepted = number || (mnemonic.operand == Operand::RegisterOrNumber && operand.kind == Token::Kind::Register);
+				if (!accepted)
+				{
+					return std::unexpected(error(LoadError::Kind::Syntax, operand, std::format("{} expects {}, found {}",
+						name, mnemonic.operand == Operand::Number ? "a jump target" : "a register or an address", describe(operand))));
+				}
+				line = operand.line;
+
+				const var_t value = operand.value;
+				switch (mnemonic.op)
+				{
+				case Op::LOAD:
+				case Op::STORE:
+					if (value > std::numeric_limits<uint32_t>::max())
+						return std::unexpected(error(LoadError::Kind::Operand, operand, std::format("memory address {} out of range", value)));
+					ins.arg = static_cast<uint32_t>(value);
+					break;
+				case Op::JUMP:
+				case Op::JPOS:
+				case Op::JZERO:
+				case Op::CALL:
+					// checked against the program size once it is known
+					if (value > std::numeric_limits<uint32_t>::max())
+						jump_errors.push_back(JumpError { .instruction = program.code.size(), .line = line, .target = value });
+					else
+						ins.arg = static_cast<uint32_t>(value);
+					break;
+				default:
+					if (value >= 8)
+						return std::unexpected(error(LoadError::Kind::Operand, operand, std::format("register {} does not exist", value)));
+					ins.reg = static_cast<uint8_t>(value);
+					break;
+				}
+			}
+
+			program.code.push_back(ins);
+			line_of.push_back(line);
+		}
+
+		for (size_t i = 0; i < program.code.size(); i++)
+		{
+			const Instruction& ins = program.code[i];
+			const bool jump = ins.op == Op::JUMP || ins.op == Op::JPOS || ins.op == Op::JZERO || ins.op == Op::CALL;
+			if (jump && ins.arg >= program.code.size())
+				jump_errors.push_back(JumpError { .instruction = i, .line = line_of[i], .target = ins.arg });
+		}
+		if (!jump_errors.empty())
+		{
+			std::sort(jump_errors.begin(), jump_errors.end(), [](const JumpError& a, const JumpError& b) { return a.instruction < b.instruction; });
+			return std::unexpected(LoadError { .kind = LoadError::Kind::Operand, .line = 0, .column = 0, .message = describeJumpErrors(jump_errors) });
+		}
+
+		buildBlocks(program);
+		return program;
+	}
+
+	std::expected<Program, LoadError> loadProgram(const std::filesystem::path& path, std::vector<int>* lines)
+	{
+		auto file = MappedFile::open(path);
+		if (!file)
+			return std::unexpected(file.error());
+		if (isImage(file->view()))
+			return readImage(file->view(), lines);
+		return parseProgram(file->view(), lines);
+	}
+
+} // namespace vm
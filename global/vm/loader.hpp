@@ -0,0 +1,51 @@
+#pragma once
+
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "program.hpp"
+
+
+namespace vm
+{
+
+// Why a program could not be loaded, with the position of the offending token
+struct LoadError
+{
+	enum class Kind
+	{
+		Io,			// the file cannot be opened or mapped
+		Symbol,		// a character or word that is not part of the language
+		Syntax,		// a missing or unexpected operand
+		Operand,	// register, address or jump target out of range
+		Format,		// a damaged binary image, or one written by another version
+	};
+
+	Kind kind;
+	int line;			// 1-based, 0 if the error is not tied to a position
+	int column;			// 1-based, 0 if the error is not tied to a position
+	std::string message;
+
+	// "line L:C: message", or just the message
+	std::string describe() const;
+};
+
+/**
+ * @brief Loads a .mr file without flex and bison: the file is mapped into memory, tokenized in place
+ * and decoded straight into Program::code. A binary image (.mrb, see image.hpp) is recognised by its
+ * magic and read with readImage() instead.
+ *
+ * @details
+ * Accepts the language of the bison parser (a mnemonic and its operand, separated by any whitespace,
+ * `#` comments up to the end of the line) and checks registers, addresses and jump targets like decode().
+ * @param lines	if given, receives the source line of every instruction (the line of its last token, like load_program)
+ */
+std::expected<Program, LoadError> loadProgram(const std::filesystem::path& path, std::vector<int>* lines = nullptr);
+
+// The same for a program that is already in memory
+std::expected<Program, LoadError> parseProgram(std::string_view source, std::vector<int>* lines = nullptr);
+
+} // namespace vm
@@ -0,0 +1,464 @@
+#include "loops.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <bit>
+#include <algorithm>
+
+
+namespace vm
+{
+
+	namespace
+	{
+		constexpr size_t max_vars = 32;		// 8 registers + memory cells
+		constexpr size_t max_trace = 4096;	// instructions per iteration
+
+		using u64 = uint64_t;
+		using i128 = __int128;
+
+		constexpr u64 unbounded = std::numeric_limits<u64>::max();
+
+		// c + sum(coeff[i] * s[i]) mod 2^64, where s is the state at the start of the iteration
+		struct Form
+		{
+			std::array<u64, max_vars> coeff {};
+			u64 c = 0;
+
+			static Form variable(const size_t i)
+			{
+				Form f;
+				f.coeff[i] = 1;
+				return f;
+			}
+
+			static Form constant(const var_t value)
+			{
+				Form f;
+				f.c = static_cast<u64>(value);
+				return f;
+			}
+
+			Form operator+(const Form& other) const
+			{
+				Form f = *this;
+				for (size_t i = 0; i < max_vars; i++)
+					f.coeff[i] += other.coeff[i];
+				f.c += other.c;
+				return f;
+			}
+
+			Form operator-(const Form& other) const
+			{
+				Form f = *this;
+				for (size_t i = 0; i < max_vars; i++)
+					f.coeff[i] -= other.coeff[i];
+				f.c -= other.c;
+				return f;
+			}
+
+			bool isConstant() const
+			{
+				return std::all_of(coeff.begin(), coeff.end(), [](const u64 a) { return a == 0; });
+			}
+		};
+
+		// a register or memory cell: symbolic form plus the value it has in this particular iteration
+		struct Value
+		{
+			Form form;
+			var_t concrete;
+		};
+
+		enum class Predicate { GE, LT, GT, LE, EQ, NE };
+
+		// lhs <pred> rhs held in the traced iteration and must keep holding
+		struct Guard
+		{
+			Form lhs, rhs;
+			var_t lhs0, rhs0;
+			Predicate pred;
+		};
+
+		struct Trace
+		{
+			std::array<Value, 8> reg;
+			std::vector<Value> cells;		// variable 8 + i
+			std::vector<var_t> cell_address;
+			std::vector<var_t> cell_initial;
+			std::vector<Form> addresses;	// RLOAD/RSTORE address forms
+			std::vector<Guard> guards;
+			size_t vars = 8;
+			size_t steps = 0;
+			var_t cost = 0;
+		};
+
+		var_t wrapAdd(const var_t a, const var_t b) { return static_cast<var_t>(static_cast<u64>(a) + static_cast<u64>(b)); }
+		var_t wrapSub(const var_t a, const var_t b) { return static_cast<var_t>(static_cast<u64>(a) - static_cast<u64>(b)); }
+
+		Value* cell(Trace& trace, const var_t address, const PagedMemory& pam)
+		{
+			for (size_t i = 0; i < trace.cell_address.size(); i++)
+				if (trace.cell_address[i] == address)
+					return &trace.cells[i];
+
+			if (trace.vars == max_vars)
+				return nullptr;
+
+			const var_t value = pam.load(address);
+			trace.cells.push_back(Value { Form::variable(trace.vars), value });
+			trace.cell_address.push_back(address);
+			trace.cell_initial.push_back(value);
+			trace.vars++;
+			return &trace.cells.back();
+		}
+
+		void guard(Trace& trace, const Value& lhs, const Value& rhs, const Predicate pred)
+		{
+			trace.guards.push_back(Guard { lhs.form, rhs.form, lhs.concrete, rhs.concrete, pred });
+		}
+
+		// executes one iteration from `head` back to `head` over forms
+		std::optional<Trace> traceIteration(const Program& program, const uint32_t head, const std::array<var_t, 8>& r, const PagedMemory& pam)
+		{
+			const auto& code = program.code;
+			const Value zero { Form::constant(0), 0 };
+
+			Trace trace;
+			for (size_t i = 0; i < 8; i++)
+				trace.reg[i] = Value { Form::variable(i), r[i] };
+
+			auto& reg = trace.reg;
+			uint32_t pc = head;
+
+			auto sub = [&](const uint8_t x) {
+				const bool ge = reg[0].concrete >= reg[x].concrete;
+				guard(trace, reg[0], reg[x], ge ? Predicate::GE : Predicate::LT);
+				reg[0] = ge ? Value { reg[0].form - reg[x].form, wrapSub(reg[0].concrete, reg[x].concrete) } : zero;
+			};
+			auto jump = [&](const bool taken, const uint32_t target, const uint32_t fallthrough) {
+				pc = taken ? target : fallthrough;
+				trace.cost += program.entry_cost[pc];
+			};
+			auto load = [&](const var_t address) -> bool {
+				Value* value = cell(trace, address, pam);
+				if (!value)
+					return false;
+				reg[0] = *value;
+				return true;
+			};
+			auto store = [&](const var_t address) -> bool {
+				Value* value = cell(trace, address, pam);
+				if (!value)
+					return false;
+				*value = reg[0];
+				return true;
+			};
+
+			do
+			{
+				if (pc >= code.size() || ++trace.steps > max_trace)
+					return std::nullopt;
+
+				const Instruction ins = code[pc];
+				const uint8_t x = ins.reg;
+
+				switch (ins.op)
+				{
+				case Op::LOAD:
+					if (!load(ins.arg))
+						return std::nullopt;
+					pc++;
+					break;
+				case Op::STORE:
+					if (!store(ins.arg))
+						return std::nullopt;
+					pc++;
+					break;
+				case Op::RLOAD:
+					trace.addresses.push_back(reg[x].form);
+					if (!load(reg[x].concrete))
+						return std::nullopt;
+					pc++;
+					break;
+				case Op::RSTORE:
+					trace.addresses.push_back(reg[x].form);
+					if (!store(reg[x].concrete))
+						return std::nullopt;
+					pc++;
+					break;
+
+				case Op::ADD:
+					reg[0] = Value { reg[0].form + reg[x].form, wrapAdd(reg[0].concrete, reg[x].concrete) };
+					pc++;
+					break;
+				case Op::SUB:
+					sub(x);
+					pc++;
+					break;
+				case Op::SWP:
+					std::swap(reg[0], reg[x]);
+					pc++;
+					break;
+
+				case Op::RST:
+					reg[x] = zero;
+					pc++;
+					break;
+				case Op::INC:
+					reg[x] = Value { reg[x].form + Form::constant(1), wrapAdd(reg[x].concrete, 1) };
+					pc++;
+					break;
+				case Op::DEC:
+					guard(trace, reg[x], zero, reg[x].concrete > 0 ? Predicate::GT : Predicate::LE);
+					if (reg[x].concrete > 0)
+						reg[x] = Value { reg[x].form - Form::constant(1), reg[x].concrete - 1 };
+					pc++;
+					break;
+				case Op::SHL:
+					reg[x] = Value { reg[x].form + reg[x].form, wrapAdd(reg[x].concrete, reg[x].concrete) };
+					pc++;
+					break;
+				case Op::SHR:
+					if (!reg[x].form.isConstant())
+						return std::nullopt;
+					reg[x] = Value { Form::constant(reg[x].concrete >> 1), reg[x].concrete >> 1 };
+					pc++;
+					break;
+
+				case Op::JUMP:
+					jump(true, ins.arg, pc + 1);
+					break;
+				case Op::JPOS:
+					guard(trace, reg[0], zero, reg[0].concrete > 0 ? Predicate::GT : Predicate::LE);
+					jump(reg[0].concrete > 0, ins.arg, pc + 1);
+					break;
+				case Op::JZERO:
+					guard(trace, reg[0], zero, reg[0].concrete == 0 ? Predicate::EQ : Predicate::NE);
+					jump(reg[0].concrete == 0, ins.arg, pc + 1);
+					break;
+
+				case Op::SET:
+					reg[x] = Value { Form::constant(program.constants[ins.arg]), program.constants[ins.arg] };
+					pc += ins.aux;
+					break;
+				case Op::LOAD_SWP:
+					if (!load(ins.arg))
+						return std::nullopt;
+					std::swap(reg[0], reg[x]);
+					pc += 2;
+					break;
+				case Op::SUB_JZERO:
+					sub(x);
+					guard(trace, reg[0], zero, reg[0].concrete == 0 ? Predicate::EQ : Predicate::NE);
+					jump(reg[0].concrete == 0, ins.arg, pc + 2);
+					break;
+				case Op::SUB_JPOS:
+					sub(x);
+					guard(trace, reg[0], zero, reg[0].concrete > 0 ? Predicate::GT : Predicate::LE);
+					jump(reg[0].concrete > 0, ins.arg, pc + 2);
+					break;
+
+				default:	// I/O, CALL, RTRN, HALT
+					return std::nullopt;
+				}
+			} while (pc != head);
+
+			return trace;
+		}
+
+		u64 evaluate(const Form& form, const std::vector<var_t>& state)
+		{
+			u64 value = form.c;
+			for (size_t i = 0; i < state.size(); i++)
+				value += form.coeff[i] * static_cast<u64>(state[i]);
+			return value;
+		}
+
+		u64 clamp(const i128 k)
+		{
+			return k >= static_cast<i128>(unbounded) ? unbounded : static_cast<u64>(k);
+		}
+
+		// number of leading k >= 0 for which value0 + k * step stays inside var_t
+		u64 rangeBound(const i128 value0, const i128 step)
+		{
+			constexpr i128 lo = std::numeric_limits<var_t>::min();
+			constexpr i128 hi = std::numeric_limits<var_t>::max();
+			if (step > 0)
+				return clamp((hi - value0) / step + 1);
+			if (step < 0)
+				return clamp((value0 - lo) / -step + 1);
+			return unbounded;
+		}
+
+		// number of leading k >= 0 for which (d0 + k * step) <pred> 0 holds, given that it holds for k = 0
+		u64 predicateBound(const i128 d0, const i128 step, const Predicate pred)
+		{
+			switch (pred)
+			{
+			case Predicate::GE:	return step >= 0 ? unbounded : clamp(d0 / -step + 1);
+			case Predicate::GT:	return step >= 0 ? unbounded : clamp((d0 + -step - 1) / -step);
+			case Predicate::LE:	return predicateBound(-d0, -step, Predicate::GE);
+			case Predicate::LT:	return predicateBound(-d0, -step, Predicate::GT);
+			case Predicate::EQ:	return step == 0 ? unbounded : 1;
+			case Predicate::NE:
+				if (step == 0 || (-d0) % step != 0 || (-d0) / step <= 0)
+					return unbounded;
+				return clamp((-d0) / step);
+			}
+			return 0;
+		}
+
+		using Matrix = std::vector<u64>;
+
+		Matrix multiply(const Matrix& a, const Matrix& b, const size_t n)
+		{
+			Matrix c(n * n, 0);
+			for (size_t i = 0; i < n; i++)
+				for (size_t k = 0; k < n; k++)
+				{
+					const u64 aik = a[i * n + k];
+					if (aik == 0)
+						continue;
+					for (size_t j = 0; j < n; j++)
+						c[i * n + j] += aik * b[k * n + j];
+				}
+			return c;
+		}
+
+	} // namespace
+
+
+	uint64_t LoopAccelerator::fastForward(const uint32_t head, std::array<var_t, 8>& r, PagedMemory& pam, var_t& t)
+	{
+		const std::optional<Trace> traced = traceIteration(m_program, head, r, pam);
+		if (!traced)
+			return 0;
+		const Trace& trace = *traced;
+		const size_t n = trace.vars;
+
+		std::vector<var_t> s0(r.begin(), r.end());
+		s0.insert(s0.end(), trace.cell_initial.begin(), trace.cell_initial.end());
+
+		std::vector<const Form*> next(n);
+		for (size_t i = 0; i < n; i++)
+			next[i] = (i < 8) ? &trace.reg[i].form : &trace.cells[i - 8].form;
+
+		// invariant: unchanged by an iteration; linear: changes by an amount that only depends on invariants
+		std::vector<bool> invariant(n), linear(n);
+		std::vector<Form> delta(n);
+		for (size_t i = 0; i < n; i++)
+		{
+			delta[i] = *next[i] - Form::variable(i);
+			invariant[i] = delta[i].isConstant() && delta[i].c == 0;
+		}
+		for (size_t i = 0; i < n; i++)
+		{
+			linear[i] = true;
+			for (size_t j = 0; j < n; j++)
+				if (delta[i].coeff[j] != 0 && !invariant[j])
+					linear[i] = false;
+		}
+
+		for (const Form& address : trace.addresses)
+			for (size_t j = 0; j < n; j++)
+				if (address.coeff[j] != 0 && !invariant[j])
+					return 0;
+
+		std::vector<u64> step(n);
+		for (size_t i = 0; i < n; i++)
+			step[i] = linear[i] ? evaluate(delta[i], s0) : 0;
+
+		// per-iteration change of a form over linear variables
+		auto formStep = [&](const Form& form) -> std::optional<i128> {
+			u64 d = 0;
+			for (size_t j = 0; j < n; j++)
+			{
+				if (form.coeff[j] == 0)
+					continue;
+				if (!linear[j])
+					return std::nullopt;
+				d += form.coeff[j] * step[j];
+			}
+			return static_cast<i128>(static_cast<var_t>(d));
+		};
+
+		u64 iterations = unbounded;
+		for (const Guard& g : trace.guards)
+		{
+			const auto lhs_step = formStep(g.lhs);
+			const auto rhs_step = formStep(g.rhs);
+			if (!lhs_step || !rhs_step)
+				return 0;
+
+			iterations = std::min({
+				iterations,
+				rangeBound(g.lhs0, *lhs_step),
+				rangeBound(g.rhs0, *rhs_step),
+				predicateBound(i128(g.lhs0) - g.rhs0, *lhs_step - *rhs_step, g.pred),
+			});
+		}
+
+		// no exit on this path (the loop never ends) or nothing to gain
+		if (iterations == unbounded || trace.cost <= 0)
+			return 0;
+		iterations = std::min<u64>(iterations, (std::numeric_limits<var_t>::max() - t) / trace.cost);
+
+		// only invariant-free rows take part in the matrix power; invariants fold into the constant column
+		std::vector<size_t> live;
+		for (size_t i = 0; i < n; i++)
+			if (!invariant[i])
+				live.push_back(i);
+		const size_t m = live.size() + 1;
+
+		// a power costs about 2 * m^3 * log2(K) multiplications; stepping costs K * steps instructions
+		if (iterations < 2 || static_cast<double>(iterations) * trace.steps < 2.0 * m * m * m * std::bit_width(iterations) / 16)
+			return 0;
+
+		Matrix step_matrix(m * m, 0);
+		for (size_t row = 0; row < live.size(); row++)
+		{
+			const Form& form = *next[live[row]];
+			u64 constant = form.c;
+			for (size_t j = 0; j < n; j++)
+				if (invariant[j])
+					constant += form.coeff[j] * static_cast<u64>(s0[j]);
+			for (size_t col = 0; col < live.size(); col++)
+				step_matrix[row * m + col] = form.coeff[live[col]];
+			step_matrix[row * m + m - 1] = constant;
+		}
+		step_matrix[m * m - 1] = 1;
+
+		Matrix power(m * m, 0);
+		for (size_t i = 0; i < m; i++)
+			power[i * m + i] = 1;
+		for (u64 k = iterations; k != 0; k >>= 1)
+		{
+			if (k & 1)
+				power = multiply(power, step_matrix, m);
+			if (k > 1)
+				step_matrix = multiply(step_matrix, step_matrix, m);
+		}
+
+		std::vector<var_t> result(s0);
+		for (size_t row = 0; row < live.size(); row++)
+		{
+			u64 value = power[row * m + m - 1];
+			for (size_t col = 0; col < live.size(); col++)
+				value += power[row * m + col] * static_cast<u64>(s0[live[col]]);
+			result[live[row]] = static_cast<var_t>(value);
+		}
+
+		for (size_t i = 0; i < 8; i++)
+			r[i] = result[i];
+		for (size_t i = 8; i < n; i++)
+			if (!invariant[i])
+				pam.store(trace.cell_address[i - 8], result[i]);
+
+		t += static_cast<var_t>(iterations) * trace.cost;
+		return iterations;
+	}
+
+} // namespace vm
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "program.hpp"
+#include "memory.hpp"
+
+
+namespace vm
+{
+
+/**
+ * @brief Fast-forwards counted loops in closed form.
+ *
+ * @details
+ * When a backward branch to `head` becomes hot, one iteration starting at `head` is traced over
+ * affine forms (mod 2^64) of the registers and of the memory cells it touches, following the
+ * branches the current state takes. Every data-dependent decision on the way (SUB/DEC clamping,
+ * JZERO/JPOS) is recorded as a guard. The loop is accelerated only if
+ *  - the iteration has no I/O, CALL/RTRN, HALT or non-constant SHR,
+ *  - RLOAD/RSTORE addresses do not change between iterations,
+ *  - every guard compares values that change by a fixed amount per iteration (exactly, without overflow),
+ * in which case the number of iterations K for which all guards keep their outcome is computed,
+ * the state is advanced by K iterations with a matrix power and K times the iteration cost is charged.
+ * The result is identical to stepping; execution then resumes at `head` and exits the loop normally.
+ */
+class LoopAccelerator
+{
+private:
+
+	struct Head
+	{
+		uint32_t countdown = 2;
+		uint32_t backoff = 2;
+	};
+
+	const Program& m_program;
+	std::vector<Head> m_heads;
+
+public:
+
+	explicit LoopAccelerator(const Program& program)
+		: m_program(program), m_heads(program.code.size())
+	{
+	}
+
+	/**
+	 * @brief Call after a backward branch to `head` has been taken and charged.
+	 *
+	 * @return number of iterations applied (0 if the loop was not accelerated)
+	 */
+	uint64_t onBackEdge(const uint32_t head, std::array<var_t, 8>& r, PagedMemory& pam, var_t& t)
+	{
+		Head& state = m_heads[head];
+		if (--state.countdown != 0) [[likely]]
+			return 0;
+
+		const uint64_t iterations = fastForward(head, r, pam, t);
+		if (iterations != 0)
+		{
+			state.backoff = 2;
+		}
+		else if (state.backoff < (1u << 20))
+		{
+			state.backoff *= 2;
+		}
+		state.countdown = state.backoff;
+
+		return iterations;
+	}
+
+private:
+
+	uint64_t fastForward(const uint32_t head, std::array<var_t, 8>& r, PagedMemory& pam, var_t& t);
+};
+
+} // namespace vm
@@ -0,0 +1,526 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "program.hpp"
+#include "memory.hpp"
+#include "loops.hpp"
+#include "word.hpp"
+
+
+namespace vm
+{
+
+// Registers start with whatever rand() returned in the original VM. One generator per thread, seeded once,
+// so that machines running in parallel (benchmark and fuzzer workers) neither race on nor reseed a shared state.
+inline int initialRegister()
+{
+	thread_local std::mt19937 engine(std::random_device{}());
+	return std::uniform_int_distribution<int>(0, std::numeric_limits<int>::max())(engine);
+}
+
+enum class Status
+{
+	Running,		// stopped after step() or at a limit of run(), can continue
+	Halted,			// reached HALT
+	Breakpoint,		// arrived at an instruction the Breakpoints policy asked to stop at
+	InputExhausted,	// READ past the end of the input
+	BadJump,		// control reached a nonexistent instruction (`lr` holds it)
+};
+
+
+// ---- policies ---------------------------------------------------------------------------------
+// Every policy is a plain type; disabled hooks are `if constexpr`'d away, so Machine<> with the
+// defaults compiles to the bare interpreter loop.
+
+// Tracing: `operator()(pc, instruction)` is called before every executed instruction.
+struct NoTrace
+{
+	static constexpr bool enabled = false;
+	void operator()(const var_t, const Instruction&) {}
+};
+
+// Breakpoints: set with Machine::setBreakpoint(), which patches a marker opcode into the machine's
+// copy of the code, so checking for them costs nothing more than the dispatch on the opcode.
+// A run stops before a marked instruction, except for the first one so that it can continue from a breakpoint.
+// The loop accelerator of run<true>() may skip over breakpoints inside the loops it fast-forwards.
+struct NoBreakpoints
+{
+	static constexpr bool enabled = false;
+};
+
+struct PatchedBreakpoints
+{
+	static constexpr bool enabled = true;
+};
+
+// Cost accounting. Both are exact once the program halts.
+// BlockCost charges Program::entry_cost whenever control arrives somewhere, so mid-block `t` runs ahead.
+// InstructionCost charges every instruction as it executes; only meaningful for unfused programs.
+struct BlockCost
+{
+	static constexpr bool per_instruction = false;
+};
+
+struct InstructionCost
+{
+	static constexpr bool per_instruction = true;
+};
+
+// Dispatch: how control gets from one handler to the next; both run the same handlers in execute().
+// SwitchDispatch goes back to one central switch after every instruction. ThreadedDispatch ends every handler
+// with its own indirect jump (labels-as-values), which branch predictors handle far better; it needs GCC or
+// Clang and falls back to the switch elsewhere.
+struct SwitchDispatch
+{
+	static constexpr bool threaded = false;
+};
+
+struct ThreadedDispatch
+{
+	static constexpr bool threaded = true;
+};
+
+// I/O: `read(value)` returns false once the input is exhausted, `write(value)` receives every WRITE.
+// The policy also fixes the word type of the machine (`Word`, see word.hpp).
+template <class W = var_t>
+class VectorIO
+{
+private:
+
+	const std::vector<W>& m_cin;
+	size_t m_next = 0;
+	std::vector<W>& m_output;
+
+public:
+
+	using Word = W;
+
+	VectorIO(const std::vector<W>& cin, std::vector<W>& output)
+		: m_cin(cin), m_output(output)
+	{
+	}
+
+	bool read(W& value)
+	{
+		if (m_next >= m_cin.size())
+			return false;
+		value = m_cin[m_next++];
+		return true;
+	}
+
+	void write(const W& value)
+	{
+		m_output.push_back(value);
+	}
+};
+
+
+/**
+ * @brief The reference interpreter over a decoded Program, dispatching through a switch or threaded code.
+ *
+ * @details
+ * Shared by the benchmarker's Switch and Threaded engines (no hooks, block cost) and the debugger
+ * (per-instruction cost, logging I/O), so all of them see the same semantics and the same cost.
+ * Static jump targets are validated by the decoder; only RTRN is bounds-checked, and running
+ * off the end of the program lands on a trailing trap entry.
+ * Registers and memory hold `IO::Word` (int64, int128 or BigWord); costs are always var_t.
+ * Fused programs are valid for every word type, the loop accelerator is int64-only.
+ */
+template <class Trace = NoTrace, class Breakpoints = NoBreakpoints, class Cost = BlockCost, class IO = VectorIO<>, class Dispatch = SwitchDispatch>
+class Machine
+{
+public:
+
+	using Word = typename IO::Word;
+
+	std::array<Word, 8> r;
+	var_t lr = 0;
+	var_t t = 0;
+	var_t io = 0;
+	BasicPagedMemory<Word> memory;
+
+private:
+
+	// not an instruction: replaces one that has a breakpoint, the original stays in Program::code
+	static constexpr Op breakpoint = static_cast<Op>(static_cast<uint8_t>(Op::SUB_JPOS) + 1);
+	// not an instruction: marks the slot after the last one
+	static constexpr Op trap = static_cast<Op>(static_cast<uint8_t>(Op::SUB_JPOS) + 2);
+
+	const Program& m_program;
+	std::vector<Instruction> m_code;
+	LoopAccelerator m_loops;
+
+	IO m_io;
+	Trace m_trace;
+
+	Status m_status = Status::Running;
+	uint64_t m_executed = 0;
+
+public:
+
+	Machine(const Program& program, IO io, Trace trace = {})
+		: m_program(program), m_loops(program), m_io(std::move(io)), m_trace(std::move(trace))
+	{
+		m_code.reserve(program.code.size() + 1);
+		m_code.assign(program.code.begin(), program.code.end());
+		m_code.push_back(Instruction { .op = trap, .reg = 0, .aux = 0, .arg = 0 });
+
+		for (int i = 0; i < 8; i++)
+			r[i] = Word(initialRegister());
+
+		if constexpr (!Cost::per_instruction)
+			t = program.entry_cost[0];
+	}
+
+	Status status() const { return m_status; }
+	// instructions the last run(steps, until_cost) executed, whichever way it stopped
+	uint64_t executed() const { return m_executed; }
+	var_t cost() const { return t + io; }
+
+	const Program& program() const { return m_program; }
+	IO& io_policy() { return m_io; }
+	Trace& trace() { return m_trace; }
+
+	// executes a single instruction
+	Status step() { return execute<true, false, false>(); }
+
+	// runs until HALT, an error or a breakpoint; FastForward enables the loop accelerator
+	template <bool FastForward = false>
+	Status run() { return execute<false, FastForward, false>(); }
+
+	// the same, but also stops with Status::Running once `steps` instructions have executed or before
+	// the next instruction once cost() reached `until_cost` (exact with InstructionCost only)
+	Status run(const uint64_t steps, const var_t until_cost = std::numeric_limits<var_t>::max())
+	{
+		return execute<false, false, true>(steps, until_cost);
+	}
+
+	// a breakpoint on an instruction that does not exist is ignored
+	void setBreakpoint(const var_t pc)
+	{
+		static_assert(Breakpoints::enabled, "the Breakpoints policy of this machine does not check breakpoints");
+		if (pc >= 0 && pc < static_cast<var_t>(m_program.code.size()))
+			m_code[pc].op = breakpoint;
+	}
+
+	void clearBreakpoint(const var_t pc)
+	{
+		if (pc >= 0 && pc < static_cast<var_t>(m_program.code.size()))
+			m_code[pc] = m_program.code[pc];
+	}
+
+	bool hasBreakpoint(const var_t pc) const
+	{
+		return pc >= 0 && pc < static_cast<var_t>(m_program.code.size()) && m_code[pc].op == breakpoint;
+	}
+
+private:
+
+	template <bool Single, bool FastForward, bool Limited>
+	Status execute(uint64_t steps = 0, const var_t until_cost = 0)
+	{
+		[[maybe_unused]] const uint64_t budget = steps;
+		if constexpr (Limited)
+			m_executed = 0;
+		if (m_status != Status::Running && m_status != Status::Breakpoint)
+			return m_status;
+
+#if defined(__GNUC__)
+		constexpr bool threaded = Dispatch::threaded;
+		// anything that has to look at an instruction before it executes
+		constexpr bool hooks = Single || Limited || Breakpoints::enabled || Trace::enabled || Cost::per_instruction;
+#endif
+
+		const Instruction* code = m_code.data();
+		const var_t* entry_cost = m_program.entry_cost.data();
+		const var_t* constants = m_program.constants.data();
+		const var_t code_size = static_cast<var_t>(m_program.code.size());
+
+		// work on locals: stores into memory cannot alias them, so they stay in registers
+		std::array<Word, 8> r = this->r;
+		var_t lr = this->lr;
+		var_t t = this->t;
+		var_t io = this->io;
+		Word tmp;
+		const Instruction* ins;
+		var_t pc;
+		Status status = Status::Running;
+		bool first = true;
+
+		// control arrived at `lr` from `pc`
+		auto transfer = [&](const Op op) {
+			if constexpr (!Cost::per_instruction)
+				t += entry_cost[lr];
+			if constexpr (FastForward)
+			{
+				static_assert(std::is_same_v<Word, var_t>, "the loop accelerator works modulo 2^64");
+				if (lr <= pc && op != Op::CALL && op != Op::RTRN)
+					m_loops.onBackEdge(static_cast<uint32_t>(lr), r, memory, t);
+			}
+		};
+
+		// points `ins` at the instruction at `lr`; false if the run stops before it
+		auto fetch = [&]() {
+			if constexpr (Single)
+			{
+				if (!first)
+					return false;
+			}
+
+			ins = code + lr;
+			pc = lr;
+
+			if constexpr (Breakpoints::enabled)
+			{
+				if (ins->op == breakpoint)
+				{
+					if (!first)
+					{
+						status = Status::Breakpoint;
+						return false;
+					}
+					ins = &m_program.code[pc];
+					if (ins->op == Op::HALT)
+					{
+						status = Status::Halted;
+						return false;
+					}
+				}
+			}
+			if constexpr (Limited)
+			{
+				if (steps == 0 || t + io >= until_cost)
+					return false;
+				steps--;
+			}
+			first = false;
+
+			if constexpr (Trace::enabled)
+				m_trace(pc, *ins);
+			if constexpr (Cost::per_instruction)
+				t += instructionCost(ins->op);
+			return true;
+		};
+
+		// Every handler below is a case of the switch and, with ThreadedDispatch, also a label that the
+		// previous handler jumps to directly through `handlers`. Without hooks HALT needs no check of its
+		// own: fetching it has no side effects, so it is dispatched to its handler like any other opcode.
+#if defined(__GNUC__)
+#define FLTT_VM_HANDLER(name) case Op::name: op_##name: __attribute__((unused));
+#define FLTT_VM_NEXT() \
+		if constexpr (threaded) \
+		{ \
+			if ((hooks && code[lr].op == Op::HALT) || !fetch()) \
+				goto done; \
+			goto *handlers[static_cast<uint8_t>(ins->op)]; \
+		} \
+		else \
+			break
+#else
+#define FLTT_VM_HANDLER(name) case Op::name:
+#define FLTT_VM_NEXT() break
+#endif
+
+#if defined(__GNUC__)
+		const void* const* handlers = nullptr;
+		if constexpr (threaded)
+		{
+			// indexed by opcode, see trap and breakpoint; a breakpoint never reaches dispatch
+			static const void* const table[] = {
+				&&op_READ, &&op_WRITE,
+				&&op_LOAD, &&op_STORE, &&op_RLOAD, &&op_RSTORE,
+				&&op_ADD, &&op_SUB, &&op_SWP,
+				&&op_RST, &&op_INC, &&op_DEC, &&op_SHL, &&op_SHR,
+				&&op_JUMP, &&op_JPOS, &&op_JZERO,
+				&&op_CALL, &&op_RTRN,
+				&&op_HALT,
+				&&op_SET, &&op_LOAD_SWP, &&op_SUB_JZERO, &&op_SUB_JPOS,
+				&&op_trap, &&op_trap,
+			};
+			static_assert(std::size(table) == static_cast<size_t>(trap) + 1);
+			handlers = table;
+
+			if ((hooks && code[lr].op == Op::HALT) || !fetch())
+				goto done;
+			goto *handlers[static_cast<uint8_t>(ins->op)];
+		}
+#endif
+
+		while (code[lr].op != Op::HALT)
+		{
+			if (!fetch())
+				break;
+
+			switch (ins->op)
+			{
+			FLTT_VM_HANDLER(READ)
+				if (!m_io.read(r[0]))
+				{
+					status = Status::InputExhausted;
+					goto stop;
+				}
+				io += 100;
+				lr++;
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(WRITE)
+				m_io.write(r[0]);
+				io += 100;
+				lr++;
+				FLTT_VM_NEXT();
+
+			FLTT_VM_HANDLER(LOAD)
+				r[0] = memory.load(Word(ins->arg));
+				lr++;
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(STORE)
+				memory.store(Word(ins->arg), r[0]);
+				lr++;
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(RLOAD)
+				r[0] = memory.load(r[ins->reg]);
+				lr++;
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(RSTORE)
+				memory.store(r[ins->reg], r[0]);
+				lr++;
+				FLTT_VM_NEXT();
+
+			FLTT_VM_HANDLER(ADD)
+				r[0] = WordTraits<Word>::add(r[0], r[ins->reg]);
+				lr++;
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(SUB)
+				r[0] = WordTraits<Word>::sub(r[0], r[0] >= r[ins->reg] ? r[ins->reg] : r[0]);
+				lr++;
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(SWP)
+				tmp = r[ins->reg];
+				r[ins->reg] = r[0];
+				r[0] = tmp;
+				lr++;
+				FLTT_VM_NEXT();
+
+			FLTT_VM_HANDLER(RST)
+				r[ins->reg] = 0;
+				lr++;
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(INC)
+				r[ins->reg] = WordTraits<Word>::add(r[ins->reg], Word(1));
+				lr++;
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(DEC)
+				if (r[ins->reg] > 0)
+					r[ins->reg]--;
+				lr++;
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(SHL)
+				r[ins->reg] <<= 1;
+				lr++;
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(SHR)
+				r[ins->reg] >>= 1;
+				lr++;
+				FLTT_VM_NEXT();
+
+			FLTT_VM_HANDLER(JUMP)
+				lr = ins->arg;
+				transfer(ins->op);
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(JPOS)
+				if (r[0] > 0)
+					lr = ins->arg;
+				else
+					lr++;
+				transfer(ins->op);
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(JZERO)
+				if (r[0] == 0)
+					lr = ins->arg;
+				else
+					lr++;
+				transfer(ins->op);
+				FLTT_VM_NEXT();
+
+			FLTT_VM_HANDLER(CALL)
+				r[0] = Word(lr + 1);
+				lr = ins->arg;
+				transfer(ins->op);
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(RTRN)
+				if (r[0] < Word(0) || r[0] >= Word(code_size))
+				{
+					lr = WordTraits<Word>::toInt64(r[0]).value_or(code_size);
+					status = Status::BadJump;
+					goto stop;
+				}
+				lr = *WordTraits<Word>::toInt64(r[0]);
+				transfer(ins->op);
+				FLTT_VM_NEXT();
+
+			FLTT_VM_HANDLER(HALT)
+				goto done;
+
+			FLTT_VM_HANDLER(SET)
+				r[ins->reg] = Word(constants[ins->arg]);
+				lr += ins->aux;
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(LOAD_SWP)
+				r[0] = memory.load(Word(ins->arg));
+				tmp = r[ins->reg];
+				r[ins->reg] = r[0];
+				r[0] = tmp;
+				lr += 2;
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(SUB_JZERO)
+				r[0] = WordTraits<Word>::sub(r[0], r[0] >= r[ins->reg] ? r[ins->reg] : r[0]);
+				if (r[0] == 0)
+					lr = ins->arg;
+				else
+					lr += 2;
+				transfer(ins->op);
+				FLTT_VM_NEXT();
+			FLTT_VM_HANDLER(SUB_JPOS)
+				r[0] = WordTraits<Word>::sub(r[0], r[0] >= r[ins->reg] ? r[ins->reg] : r[0]);
+				if (r[0] > 0)
+					lr = ins->arg;
+				else
+					lr += 2;
+				transfer(ins->op);
+				FLTT_VM_NEXT();
+
+			default:
+#if defined(__GNUC__)
+			op_trap: __attribute__((unused));
+#endif
+				status = Status::BadJump;
+				goto stop;
+			}
+		}
+
+#undef FLTT_VM_NEXT
+#undef FLTT_VM_HANDLER
+
+	done:
+		if (status == Status::Running && code[lr].op == Op::HALT)
+			status = Status::Halted;
+
+	stop:
+		this->r = r;
+		this->lr = lr;
+		this->t = t;
+		this->io = io;
+		if constexpr (Limited)
+			m_executed = budget - steps;
+		m_status = status;
+		return status;
+	}
+};
+
+} // namespace vm
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <utility>
+#include <type_traits>
+
+#include "../instructions.hpp"
+#include "word.hpp"
+
+
+namespace vm
+{
+
+/**
+ * @brief VM memory: every cell reads as 0 until it is written.
+ *
+ * @details
+ * Addresses in [0, dense_cells) go through a flat page table whose pages are allocated on first store,
+ * so LOAD/STORE in the usual address range is two indexed loads. Anything else (huge or negative
+ * addresses produced by RLOAD/RSTORE) falls back to a hash map.
+ * Loads never allocate. Cells hold `Word` (see word.hpp); the default is the int64 word of the benchmarker.
+ */
+template <class Word = var_t>
+class BasicPagedMemory
+{
+public:
+
+	static constexpr size_t page_bits = 12;
+	static constexpr size_t page_size = size_t(1) << page_bits;
+	static constexpr size_t page_count = 4096;
+	static constexpr uint64_t dense_cells = uint64_t(page_size) * page_count;
+
+private:
+
+	std::vector<std::unique_ptr<Word[]>> m_pages;
+	std::unordered_map<Word, Word, WordHash<Word>> m_sparse;
+
+	// dense cell index, or dense_cells if the address is outside the dense range
+	static uint64_t denseIndex(const Word& address)
+	{
+		if constexpr (std::is_same_v<Word, var_t>)
+		{
+			return static_cast<uint64_t>(address);
+		}
+		else
+		{
+			const auto narrow = WordTraits<Word>::toInt64(address);
+			return narrow ? static_cast<uint64_t>(*narrow) : dense_cells;
+		}
+	}
+
+public:
+
+	BasicPagedMemory()
+		: m_pages(page_count)
+	{
+	}
+
+	Word load(const Word& address) const
+	{
+		const uint64_t a = denseIndex(address);
+		if (a < dense_cells) [[likely]]
+		{
+			const Word* page = m_pages[a >> page_bits].get();
+			return page ? page[a & (page_size - 1)] : Word(0);
+		}
+
+		auto it = m_sparse.find(address);
+		return it == m_sparse.end() ? Word(0) : it->second;
+	}
+
+	void store(const Word& address, const Word& value)
+	{
+		const uint64_t a = denseIndex(address);
+		if (a < dense_cells) [[likely]]
+		{
+			auto& page = m_pages[a >> page_bits];
+			if (!page) [[unlikely]]
+				page = std::make_unique<Word[]>(page_size);
+			page[a & (page_size - 1)] = value;
+			return;
+		}
+
+		m_sparse[address] = value;
+	}
+
+	void clear()
+	{
+		for (auto& page : m_pages)
+			page.reset();
+		m_sparse.clear();
+	}
+
+	/**
+	 * @brief Returns up to `limit` non-zero cells in ascending address order.
+	 */
+	std::vector<std::pair<Word, Word>> snapshot(const size_t limit) const
+	{
+		std::vector<std::pair<Word, Word>> sparse(m_sparse.begin(), m_sparse.end());
+		std::sort(sparse.begin(), sparse.end());
+
+		std::vector<std::pair<Word, Word>> cells;
+		auto push = [&](const Word& address, const Word& value) {
+			if (value != Word(0) && cells.size() < limit)
+				cells.emplace_back(address, value);
+		};
+
+		// negative addresses sort before the dense range, huge ones after it
+		auto first_positive = std::find_if(sparse.begin(), sparse.end(), [](const auto& cell) { return cell.first >= Word(0); });
+
+		for (auto it = sparse.begin(); it != first_positive; ++it)
+			push(it->first, it->second);
+
+		for (size_t p = 0; p < page_count && cells.size() < limit; p++)
+		{
+			if (!m_pages[p])
+				continue;
+			for (size_t i = 0; i < page_size; i++)
+				push(Word(static_cast<var_t>((p << page_bits) | i)), m_pages[p][i]);
+		}
+
+		for (auto it = first_positive; it != sparse.end(); ++it)
+			push(it->first, it->second);
+
+		return cells;
+	}
+};
+
+using PagedMemory = BasicPagedMemory<var_t>;
+
+} // namespace vm
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+
+#include "../instructions.hpp"
+
+
+namespace vm
+{
+
+// narrow opcode, same numbering as `Instructions`, followed by superinstructions produced by fuse()
+enum class Op : uint8_t
+{
+	READ, WRITE,
+	LOAD, STORE, RLOAD, RSTORE,
+	ADD, SUB, SWP,
+	RST, INC, DEC, SHL, SHR,
+	JUMP, JPOS, JZERO,
+	CALL, RTRN,
+	HALT,
+
+	SET,		// RST x; {INC x | SHL x}...	r[reg] = constants[arg], covers `aux` instructions
+	LOAD_SWP,	// LOAD n; SWP x
+	SUB_JZERO,	// SUB x; JZERO j
+	SUB_JPOS,	// SUB x; JPOS j
+};
+
+// mnemonic of every Op, indexed by its value
+inline constexpr std::string_view op_names[] = {
+	"READ", "WRITE", "LOAD", "STORE", "RLOAD", "RSTORE", "ADD", "SUB", "SWP",
+	"RST", "INC", "DEC", "SHL", "SHR", "JUMP", "JPOS", "JZERO", "CALL", "RTRN", "HALT",
+	"SET", "LOAD_SWP", "SUB_JZERO", "SUB_JPOS",
+};
+
+// Pre-decoded instruction. Operands are resolved at load time:
+//  - register instructions (RLOAD, RSTORE, ADD .. SHR) carry a register index in `reg`
+//  - memory instructions (LOAD, STORE) carry an absolute address in `arg`
+//  - jump instructions (JUMP, JPOS, JZERO, CALL) carry a validated instruction index in `arg`
+struct Instruction
+{
+	Op op;
+	uint8_t reg;
+	uint16_t aux;
+	uint32_t arg;
+};
+
+static_assert(sizeof(Instruction) == 8, "vm::Instruction should stay packed");
+
+
+// Cost charged to the `t` counter. READ and WRITE are charged to `io` by the engines themselves.
+constexpr var_t instructionCost(const Op op)
+{
+	switch (op)
+	{
+	case Op::LOAD: case Op::STORE: case Op::RLOAD: case Op::RSTORE:
+		return 50;
+	case Op::ADD: case Op::SUB: case Op::SWP:
+		return 5;
+	case Op::READ: case Op::WRITE: case Op::HALT:
+		return 0;
+	default:
+		return 1;
+	}
+}
+
+// Instructions that end a basic block
+constexpr bool isControl(const Op op)
+{
+	return op == Op::JUMP || op == Op::JPOS || op == Op::JZERO || op == Op::CALL || op == Op::RTRN || op == Op::HALT
+		|| op == Op::SUB_JZERO || op == Op::SUB_JPOS;
+}
+
+
+struct BasicBlock
+{
+	uint32_t start;		// first instruction
+	uint32_t end;		// one past the last instruction
+	var_t cost;			// static `t` cost of executing the whole block
+};
+
+
+struct Program
+{
+	std::vector<Instruction> code;
+
+	// CFG blocks in program order
+	std::vector<BasicBlock> blocks;
+
+	// entry_cost[pc]: `t` cost of the straight-line run from pc up to and including the next control instruction.
+	// Execution never leaves such a run early, so engines charge it once when control arrives at pc
+	// (program start, taken or not-taken branch, CALL, RTRN). Has one trailing 0 entry for the end of the program.
+	std::vector<var_t> entry_cost;
+
+	// operands of SET that do not fit into `arg`
+	std::vector<var_t> constants;
+};
+
+
+// Error of the running program, e.g. RTRN to an instruction that does not exist
+class RuntimeError : public std::runtime_error
+{
+public:
+	using std::runtime_error::runtime_error;
+};
+
+// Static jump (JUMP, JPOS, JZERO, CALL) whose target is not an instruction of the program
+struct JumpError
+{
+	size_t instruction;
+	int line;			// source line, 0 if unknown
+	var_t target;
+};
+
+// Checks every static jump target at load time, so engines only have to bounds-check RTRN.
+// `lines` maps instructions to source lines (see load_program) and may be empty.
+std::vector<JumpError> verifyJumps(const std::vector<std::pair<int, var_t>>& source, const std::vector<int>& lines = {});
+
+// "N invalid jump targets: line L -> T; ..." (the instruction index where the line is unknown)
+std::string describeJumpErrors(const std::vector<JumpError>& errors);
+
+// Translates parser output into the packed form; throws std::runtime_error on malformed programs,
+// listing every invalid jump target (with its source line if `lines` is given)
+Program decode(const std::vector<std::pair<int, var_t>>& source, const std::vector<int>& lines = {});
+
+// One instruction as .mr text, e.g. "LOAD 5", "ADD b", "JUMP 12". Superinstructions are shown by their
+// name and raw operands, they have no source form.
+std::string disassemble(const Instruction& instruction);
+
+// Splits the program into basic blocks and fills `blocks` and `entry_cost`; called by decode()
+void buildBlocks(Program& program);
+
+// Rewrites common instruction sequences into superinstructions, in place and within basic blocks only.
+// The head of a sequence is replaced and the remaining slots are left untouched, so instruction indices,
+// `blocks` and `entry_cost` stay valid and a dynamic jump into the middle of a sequence still works.
+// Must run after buildBlocks(); a fused program is meant for execution only (not for single-stepping).
+void fuse(Program& program);
+
+} // namespace vm
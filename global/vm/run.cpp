@@ -0,0 +1,69 @@
+#include "run.hpp"
+
+#include <format>
+#include <optional>
+#include <vector>
+
+#include "program.hpp"
+#include "engine.hpp"
+#include "machine.hpp"
+#include "jit.hpp"
+
+
+template <class Machine>
+static var_t finish(const Machine& machine, const vm::Status status)
+{
+	switch (status)
+	{
+	case vm::Status::InputExhausted:
+		return -1;
+	case vm::Status::BadJump:
+		throw vm::RuntimeError(std::format("instruction {} does not exist", machine.lr));
+	default:
+		return machine.cost();
+	}
+}
+
+template <class Dispatch, bool FastForward>
+static var_t run_machine(const vm::Program& program, const std::vector<var_t>& cin, std::vector<var_t>& output)
+{
+	vm::Machine<vm::NoTrace, vm::NoBreakpoints, vm::BlockCost, vm::VectorIO<>, Dispatch> machine(program, vm::VectorIO(cin, output));
+	return finish(machine, machine.template run<FastForward>());
+}
+
+template <class Dispatch>
+static std::optional<var_t> run_limited(const vm::Program& program, const std::vector<var_t>& cin, std::vector<var_t>& output, const uint64_t steps)
+{
+	vm::Machine<vm::NoTrace, vm::NoBreakpoints, vm::BlockCost, vm::VectorIO<>, Dispatch> machine(program, vm::VectorIO(cin, output));
+	const vm::Status status = machine.run(steps);
+	if (status == vm::Status::Running)
+		return std::nullopt;
+	return finish(machine, status);
+}
+
+
+var_t vm::run(const Program& program, const std::vector<var_t>& cin, std::vector<var_t>& output, const Engine engine, const bool fast_forward)
+{
+	if (engine == vm::Engine::Jit)
+	{
+		// the loop accelerator is interpreter-only; the JIT runs every iteration natively
+		if (const auto jit = vm::JitProgram::compile(program))
+			return jit->run(cin, output);
+	}
+	if (engine == vm::Engine::Threaded || engine == vm::Engine::Jit)
+	{
+		return fast_forward
+			? run_machine<vm::ThreadedDispatch, true>(program, cin, output)
+			: run_machine<vm::ThreadedDispatch, false>(program, cin, output);
+	}
+	return fast_forward
+		? run_machine<vm::SwitchDispatch, true>(program, cin, output)
+		: run_machine<vm::SwitchDispatch, false>(program, cin, output);
+}
+
+std::optional<var_t> vm::runLimited(const Program& program, const std::vector<var_t>& cin, std::vector<var_t>& output, const Engine engine, const uint64_t steps)
+{
+	if (engine == vm::Engine::Threaded || engine == vm::Engine::Jit)
+		return run_limited<vm::ThreadedDispatch>(program, cin, output, steps);
+	return run_limited<vm::SwitchDispatch>(program, cin, output, steps);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "program.hpp"
+#include "engine.hpp"
+
+
+namespace vm
+{
+
+/**
+ * @brief Runs a decoded program to completion on the selected engine.
+ *
+ * @return total cost (`t + io`), or -1 if the program reads past the end of `cin`;
+ * throws vm::RuntimeError on a jump to a nonexistent instruction
+ */
+var_t run(const Program& program, const std::vector<var_t>& cin, std::vector<var_t>& output, Engine engine, bool fast_forward);
+
+/**
+ * @brief The same, but gives up once `steps` instructions have executed.
+ *
+ * @details
+ * Neither the JIT nor the loop accelerator can stop midway, so Engine::Jit runs on the threaded interpreter.
+ * @return as run(), or nothing if the program was still running after `steps` instructions
+ */
+std::optional<var_t> runLimited(const Program& program, const std::vector<var_t>& cin, std::vector<var_t>& output, Engine engine, uint64_t steps);
+
+} // namespace vm
@@ -0,0 +1,41 @@
+#include "program.hpp"
+
+#include <format>
+
+
+namespace vm
+{
+
+	std::vector<JumpError> verifyJumps(const std::vector<std::pair<int, var_t>>& source, const std::vector<int>& lines)
+	{
+		std::vector<JumpError> errors;
+		const var_t size = static_cast<var_t>(source.size());
+
+		for (size_t i = 0; i < source.size(); i++)
+		{
+			const auto& [opcode, operand] = source[i];
+			if (opcode != JUMP && opcode != JPOS && opcode != JZERO && opcode != CALL)
+				continue;
+
+			if (operand < 0 || operand >= size)
+				errors.push_back(JumpError { .instruction = i, .line = i < lines.size() ? lines[i] : 0, .target = operand });
+		}
+
+		return errors;
+	}
+
+	std::string describeJumpErrors(const std::vector<JumpError>& errors)
+	{
+		std::string message = std::format("{} invalid jump target{}:", errors.size(), errors.size() == 1 ? "" : "s");
+		for (const JumpError& error : errors)
+		{
+			if (error.line > 0)
+				message += std::format(" line {} -> {};", error.line, error.target);
+			else
+				message += std::format(" instruction {} -> {};", error.instruction, error.target);
+		}
+		message.pop_back();
+		return message;
+	}
+
+} // namespace vm
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <algorithm>
+
+#include "../instructions.hpp"
+#include "bigword.hpp"
+
+
+namespace vm
+{
+
+using int128 = __int128;
+
+/**
+ * @brief What the VM needs to know about a word type besides its operators:
+ * wrapping addition and subtraction (signed overflow is undefined), text conversion for I/O,
+ * narrowing for addresses and return targets, and hashing for sparse memory.
+ */
+template <class Word>
+struct WordTraits;
+
+template <>
+struct WordTraits<var_t>
+{
+	static constexpr std::string_view name = "int64";
+
+	// ADD and INC, modulo 2^64
+	static var_t add(const var_t a, const var_t b) { return static_cast<var_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b)); }
+	// SUB, which only clamps at 0 for a non-negative subtrahend
+	static var_t sub(const var_t a, const var_t b) { return static_cast<var_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b)); }
+
+	static std::optional<var_t> toInt64(const var_t word) { return word; }
+
+	static std::optional<var_t> parse(const std::string_view text)
+	{
+		var_t value;
+		const char* begin = text.data() + (!text.empty() && text[0] == '+');
+		const auto [end, error] = std::from_chars(begin, text.data() + text.size(), value);
+		if (error != std::errc() || end != text.data() + text.size())
+			return std::nullopt;
+		return value;
+	}
+
+	static std::string toString(const var_t word) { return std::to_string(word); }
+
+	static size_t hash(const var_t word) { return std::hash<var_t>{}(word); }
+};
+
+template <>
+struct WordTraits<int128>
+{
+	static constexpr std::string_view name = "int128";
+
+	// ADD and INC, modulo 2^128
+	static int128 add(const int128 a, const int128 b)
+	{
+		return static_cast<int128>(static_cast<unsigned __int128>(a) + static_cast<unsigned __int128>(b));
+	}
+
+	static int128 sub(const int128 a, const int128 b)
+	{
+		return static_cast<int128>(static_cast<unsigned __int128>(a) - static_cast<unsigned __int128>(b));
+	}
+
+	static std::optional<var_t> toInt64(const int128 word)
+	{
+		if (word < INT64_MIN || word > INT64_MAX)
+			return std::nullopt;
+		return static_cast<var_t>(word);
+	}
+
+	// wraps modulo 2^128 like the arithmetic does
+	static std::optional<int128> parse(std::string_view text)
+	{
+		bool negative = false;
+		if (!text.empty() && (text[0] == '-' || text[0] == '+'))
+		{
+			negative = text[0] == '-';
+			text.remove_prefix(1);
+		}
+		if (text.empty())
+			return std::nullopt;
+
+		unsigned __int128 value = 0;
+		for (const char c : text)
+		{
+			if (c < '0' || c > '9')
+				return std::nullopt;
+			value = value * 10 + static_cast<unsigned>(c - '0');
+		}
+		return static_cast<int128>(negative ? 0 - value : value);
+	}
+
+	static std::string toString(const int128 word)
+	{
+		unsigned __int128 value = word < 0 ? 0 - static_cast<unsigned __int128>(word) : static_cast<unsigned __int128>(word);
+		std::string digits;
+		do
+		{
+			digits.push_back(static_cast<char>('0' + static_cast<int>(value % 10)));
+			value /= 10;
+		} while (value != 0);
+		if (word < 0)
+			digits.push_back('-');
+		std::reverse(digits.begin(), digits.end());
+		return digits;
+	}
+
+	static size_t hash(const int128 word)
+	{
+		const auto bits = static_cast<unsigned __int128>(word);
+		return std::hash<uint64_t>{}(static_cast<uint64_t>(bits)) ^ (std::hash<uint64_t>{}(static_cast<uint64_t>(bits >> 64)) * 31);
+	}
+};
+
+template <>
+struct WordTraits<BigWord>
+{
+	static constexpr std::string_view name = "bignum";
+
+	static BigWord add(BigWord a, const BigWord& b) { return a += b; }
+	static BigWord sub(BigWord a, const BigWord& b) { return a -= b; }
+
+	static std::optional<var_t> toInt64(const BigWord& word)
+	{
+		if (!word.isSmall())
+			return std::nullopt;
+		return word.small();
+	}
+
+	static std::optional<BigWord> parse(const std::string_view text) { return BigWord::parse(text); }
+	static std::string toString(const BigWord& word) { return word.toString(); }
+	static size_t hash(const BigWord& word) { return word.hash(); }
+};
+
+
+template <class Word>
+struct WordHash
+{
+	size_t operator()(const Word& word) const { return WordTraits<Word>::hash(word); }
+};
+
+} // namespace vm
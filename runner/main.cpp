@@ -0,0 +1,115 @@
+#include <iostream>
+
+#include <utility>
+#include <vector>
+#include <filesystem>
+#include <print>
+#include <string>
+#include <argparse/argparse.hpp>
+
+#include "../global/colors.hpp"
+#include "../global/instructions.hpp"
+#include "../global/vm/program.hpp"
+#include "../global/vm/loader.hpp"
+#include "../global/vm/machine.hpp"
+#include "../global/vm/word.hpp"
+
+
+// selected per build target, see CMakeLists.txt
+#if defined(FLTT_VM_WORD_INT128)
+using Word = vm::int128;
+#elif defined(FLTT_VM_WORD_BIGNUM)
+using Word = vm::BigWord;
+#else
+using Word = var_t;
+#endif
+
+
+// Console protocol of the original VM: "? " before every READ, "> " before every written value
+class ConsoleIO
+{
+public:
+
+	using Word = ::Word;
+
+	bool invalid_input = false;
+
+	bool read(Word& value)
+	{
+		std::print("? ");
+		std::string token;
+		if (!(std::cin >> token))
+			return false;
+
+		const auto parsed = vm::WordTraits<Word>::parse(token);
+		if (!parsed)
+		{
+			invalid_input = true;
+			return false;
+		}
+		value = *parsed;
+		return true;
+	}
+
+	void write(const Word& value)
+	{
+		std::println("> {}", vm::WordTraits<Word>::toString(value));
+	}
+};
+
+
+std::filesystem::path parse_args(const int argc, char const* argv[])
+{
+	argparse::ArgumentParser parser;
+	parser.add_argument<std::string>("file")
+		.help("input .mr file")
+		.required();
+
+	try
+	{
+		parser.parse_args(argc, argv);
+	}
+	catch(const std::exception& e)
+	{
+		std::println(std::cerr, "{}", e.what());
+		std::exit(1);
+	}
+
+	return parser.get<std::string>("file");
+}
+
+
+int main(const int argc, char const * argv[])
+{
+	const auto filename = parse_args(argc, argv);
+
+	auto loaded = vm::loadProgram(filename);
+	if (!loaded)
+	{
+		std::println(std::cerr, "{}Error: {}{}", cRed, loaded.error().describe(), cReset);
+		return -1;
+	}
+	vm::Program decoded = std::move(*loaded);
+	vm::fuse(decoded);
+
+	std::println("{}Running the program ({} words).{}", cBlue, vm::WordTraits<Word>::name, cReset);
+
+	vm::Machine<vm::NoTrace, vm::NoBreakpoints, vm::BlockCost, ConsoleIO> machine(decoded, ConsoleIO());
+	switch (machine.run())
+	{
+	case vm::Status::InputExhausted:
+		if (machine.io_policy().invalid_input)
+			std::println(std::cerr, "{}[RUNTIME ERROR]{}: READ expects an integer", cRed, cReset);
+		else
+			std::println(std::cerr, "{}[RUNTIME ERROR]{}: READ past the end of input", cRed, cReset);
+		return -1;
+	case vm::Status::BadJump:
+		std::println(std::cerr, "{}[RUNTIME ERROR]{}: instruction {} does not exist", cRed, cReset, machine.lr);
+		return -1;
+	default:
+		break;
+	}
+
+	std::println("{2}Program finished (cost: {3}{0}{2}; incl. i/o: {1}).{4}", machine.cost(), machine.io, cBlue, cRed, cReset);
+	return 0;
+}
@@ -0,0 +1,76 @@
+#include <iostream>
+
+#include <utility>
+#include <vector>
+#include <filesystem>
+#include <fstream>
+#include <print>
+#include <stdexcept>
+#include <argparse/argparse.hpp>
+
+#include "../global/colors.hpp"
+#include "../global/instructions.hpp"
+
+#include "../global/parser/load.hpp"
+#include "translate.hpp"
+
+
+std::pair<std::filesystem::path, std::filesystem::path> parse_args(const int argc, char const* argv[])
+{
+	argparse::ArgumentParser parser;
+	parser.add_argument<std::string>("file")
+		.help("input .mr file")
+		.required();
+	parser.add_argument<std::string>("--output", "-o")
+		.help("generated C++ file (default: input file with .cpp extension)");
+
+	try
+	{
+		parser.parse_args(argc, argv);
+	}
+	catch(const std::exception& e)
+	{
+		std::println(std::cerr, "{}", e.what());
+		std::exit(1);
+	}
+
+	std::filesystem::path input = parser.get<std::string>("file");
+	std::filesystem::path output = parser.is_used("--output") ? parser.get<std::string>("--output") : std::filesystem::path(input).replace_extension(".cpp");
+
+	return { input, output };
+}
+
+
+int main(const int argc, char const * argv[])
+{
+	auto [input, output] = parse_args(argc, argv);
+
+	const auto program = load_program(input);
+	if (!program)
+	{
+		std::println(std::cerr, "{}Error: {}{}", cRed, program.error().describe(), cReset);
+		return -1;
+	}
+
+	std::string source;
+	try
+	{
+		source = translate(program->instructions, program->lines, input.filename().string());
+	}
+	catch (const std::exception& e)
+	{
+		std::println(std::cerr, "{}Error: {}{}", cRed, e.what(), cReset);
+		return -1;
+	}
+
+	std::ofstream file(output);
+	if (!file)
+	{
+		std::println(std::cerr, "{}Error: could not open '{}'{}", cRed, output.string(), cReset);
+		return -1;
+	}
+	file << source;
+
+	std::println("{} -> {}", input.string(), output.string());
+	return 0;
+}
@@ -0,0 +1,180 @@
+#include "translate.hpp"
+
+#include <array>
+#include <format>
+#include <iterator>
+
+#include "../global/vm/program.hpp"
+
+
+namespace
+{
+	constexpr std::array<std::string_view, 20> mnemonics = {
+		"READ", "WRITE",
+		"LOAD", "STORE", "RLOAD", "RSTORE",
+		"ADD", "SUB", "SWP",
+		"RST", "INC", "DEC", "SHL", "SHR",
+		"JUMP", "JPOS", "JZERO",
+		"CALL", "RTRN",
+		"HALT",
+	};
+
+	constexpr std::array<char, 8> register_names = { 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h' };
+
+	// everything the generated program needs besides main(); memory is the VM's own, arithmetic wraps like the interpreters
+	constexpr std::string_view prelude = R"(#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <utility>
+
+#include "vm/memory.hpp"
+
+namespace
+{
+	using Word = vm::WordTraits<var_t>;
+
+	inline var_t shl(const var_t x) { return static_cast<var_t>(static_cast<uint64_t>(x) << 1); }
+
+	[[noreturn]] inline void bad_jump(const var_t lr)
+	{
+		std::cerr << "\033[31m[RUNTIME ERROR]\033[0m: instruction " << lr << " does not exist" << std::endl;
+		std::exit(-1);
+	}
+
+	[[noreturn]] inline void no_input()
+	{
+		std::cerr << "\033[31m[RUNTIME ERROR]\033[0m: READ past the end of input" << std::endl;
+		std::exit(-1);
+	}
+}
+
+)";
+
+	void emit(std::string& out, const size_t pc, const bool labelled, const vm::Instruction ins, const std::pair<int, var_t>& source)
+	{
+		const vm::Op op = ins.op;
+		const char x = register_names[ins.reg];
+		const std::string r = std::format("r[{}]", ins.reg);
+
+		if (labelled)
+			std::format_to(std::back_inserter(out), "L{}:", pc);
+		std::format_to(std::back_inserter(out), "\t// {}", mnemonics[static_cast<size_t>(op)]);
+		switch (op)
+		{
+		case vm::Op::RLOAD: case vm::Op::RSTORE:
+		case vm::Op::ADD: case vm::Op::SUB: case vm::Op::SWP:
+		case vm::Op::RST: case vm::Op::INC: case vm::Op::DEC: case vm::Op::SHL: case vm::Op::SHR:
+			std::format_to(std::back_inserter(out), " {}", x);
+			break;
+		case vm::Op::READ: case vm::Op::WRITE: case vm::Op::RTRN: case vm::Op::HALT:
+			break;
+		default:
+			std::format_to(std::back_inserter(out), " {}", source.second);
+			break;
+		}
+		out += "\n\t";
+
+		const var_t cost = vm::instructionCost(op);
+		if (cost != 0)
+			std::format_to(std::back_inserter(out), "t += {}; ", cost);
+
+		switch (op)
+		{
+		case vm::Op::READ:		out += "io += 100; std::cout << \"? \"; if (!(std::cin >> r[0])) no_input();"; break;
+		case vm::Op::WRITE:		out += "io += 100; std::cout << \"> \" << r[0] << '\\n';"; break;
+
+		case vm::Op::LOAD:		std::format_to(std::back_inserter(out), "r[0] = pam.load({});", ins.arg); break;
+		case vm::Op::STORE:		std::format_to(std::back_inserter(out), "pam.store({}, r[0]);", ins.arg); break;
+		case vm::Op::RLOAD:		std::format_to(std::back_inserter(out), "r[0] = pam.load({});", r); break;
+		case vm::Op::RSTORE:	std::format_to(std::back_inserter(out), "pam.store({}, r[0]);", r); break;
+
+		case vm::Op::ADD:		std::format_to(std::back_inserter(out), "r[0] = Word::add(r[0], {});", r); break;
+		case vm::Op::SUB:		std::format_to(std::back_inserter(out), "r[0] = Word::sub(r[0], r[0] >= {0} ? {0} : r[0]);", r); break;
+		case vm::Op::SWP:		std::format_to(std::back_inserter(out), "std::swap(r[0], {});", r); break;
+
+		case vm::Op::RST:		std::format_to(std::back_inserter(out), "{} = 0;", r); break;
+		case vm::Op::INC:		std::format_to(std::back_inserter(out), "{0} = Word::add({0}, 1);", r); break;
+		case vm::Op::DEC:		std::format_to(std::back_inserter(out), "if ({0} > 0) {0}--;", r); break;
+		case vm::Op::SHL:		std::format_to(std::back_inserter(out), "{0} = shl({0});", r); break;
+		case vm::Op::SHR:		std::format_to(std::back_inserter(out), "{} >>= 1;", r); break;
+
+		case vm::Op::JUMP:		std::format_to(std::back_inserter(out), "goto L{};", ins.arg); break;
+		case vm::Op::JPOS:		std::format_to(std::back_inserter(out), "if (r[0] > 0) goto L{};", ins.arg); break;
+		case vm::Op::JZERO:		std::format_to(std::back_inserter(out), "if (r[0] == 0) goto L{};", ins.arg); break;
+
+		case vm::Op::CALL:		std::format_to(std::back_inserter(out), "r[0] = {}; goto L{};", pc + 1, ins.arg); break;
+		case vm::Op::RTRN:		out += "goto dispatch;"; break;
+
+		case vm::Op::HALT:		out += "goto halt;"; break;
+
+		default:
+			break;
+		}
+		out += "\n";
+	}
+}
+
+
+std::string translate(const std::vector<std::pair<int, var_t>>& program, const std::vector<int>& lines, const std::string_view source_name)
+{
+	// decode() validates opcodes, operands and jump targets, so every `goto` below has a label
+	const vm::Program decoded = vm::decode(program, lines);
+	const size_t size = decoded.code.size();
+
+	bool returns = false, halts = false;
+	for (const vm::Instruction& ins : decoded.code)
+	{
+		returns |= ins.op == vm::Op::RTRN;
+		halts |= ins.op == vm::Op::HALT;
+	}
+
+	// RTRN may continue at any instruction, so then every one is labelled and has a dispatch case;
+	// without it only jump and call targets are, which leaves no unused labels behind
+	std::vector<bool> labelled(size, returns);
+	for (const vm::Instruction& ins : decoded.code)
+	{
+		if (ins.op == vm::Op::JUMP || ins.op == vm::Op::JPOS || ins.op == vm::Op::JZERO || ins.op == vm::Op::CALL)
+			labelled[ins.arg] = true;
+	}
+
+	std::string out;
+	out.reserve(64 * size + prelude.size() + 1024);
+
+	std::format_to(std::back_inserter(out), "// Translated from {} ({} instructions). Build with -O2 -I <fltt-compiler-tools>/global.\n\n", source_name, size);
+	out += prelude;
+
+	out +=
+		"int main()\n"
+		"{\n"
+		"\tvm::PagedMemory pam;\n"
+		"\tvar_t r[8];\n"
+		"\tvar_t t = 0, io = 0;\n"
+		"\n"
+		"\tstd::srand(std::time(nullptr));\n"
+		"\tfor (int i = 0; i < 8; i++)\n"
+		"\t\tr[i] = std::rand();\n"
+		"\n";
+
+	for (size_t pc = 0; pc < size; pc++)
+		emit(out, pc, labelled[pc], decoded.code[pc], program[pc]);
+
+	std::format_to(std::back_inserter(out), "\tbad_jump({});\n\n", size);
+
+	if (returns)
+	{
+		out += "dispatch:\n\tswitch (r[0])\n\t{\n";
+		for (size_t pc = 0; pc < size; pc++)
+			std::format_to(std::back_inserter(out), "\tcase {0}: goto L{0};\n", pc);
+		out += "\tdefault: bad_jump(r[0]);\n\t}\n\n";
+	}
+
+	if (halts)
+		out += "halt:\n";
+	out +=
+		"\tstd::cout << \"\\033[34mSkończono program (koszt: \\033[31m\" << (t + io) << \"\\033[34m; w tym i/o: \" << io << \").\\033[0m\" << std::endl;\n"
+		"\treturn 0;\n"
+		"}\n";
+
+	return out;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../global/instructions.hpp"
+
+
+/**
+ * @brief Translates a parsed .mr program into a C++ source file that only needs the VM's memory header.
+ *
+ * @details
+ * Every instruction becomes a statement charging its exact cost and jumps become `goto`s. If the program
+ * contains RTRN, every instruction is labelled and RTRN dispatches through a switch over all instruction
+ * indices; otherwise only jump and call targets are labelled.
+ * Memory is vm::PagedMemory (`#include "vm/memory.hpp"`, build with `-I global`). SUB and DEC clamp at zero exactly like the VM.
+ * The generated program speaks the VM's console protocol ("? " before READ, "> " before every written value)
+ * and prints the total cost on HALT, so it can replace the interpreter for repeated runs.
+ *
+ * @param lines source line of every instruction (see load_program), used in error messages; may be empty
+ * @throws std::runtime_error if the program is malformed (see vm::decode)
+ */
+std::string translate(const std::vector<std::pair<int, var_t>>& program, const std::vector<int>& lines, std::string_view source_name);